@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2014 Guitarix project MOD project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * --------------------------------------------------------------------------
+ */
+
+// Throughput of K instances run by one batch of gx_matcheq_batch.h
+// against K separate mono_audio() calls, engine 2, random gains per
+// instance and a gain and morph change halfway through. Built and run by
+// "make bench", linked against the plugin objects of the tree.
+//
+//   bench_batch [rate [frames]]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <vector>
+
+#include "gx_matcheq.h"        // define struct PortIndex
+#include "gx_matcheq_batch.h"
+
+namespace {
+
+struct Setup {
+  int k;       // instances
+  uint32_t n;  // frames per call
+};
+
+const Setup setups[] = { {8, 256}, {64, 64}, {64, 256} };
+const int repeats = 3;   // the best of them counts
+
+// the ports of one instance
+struct Ports {
+  float value[PORTS_SHARED];
+};
+
+class Instances {
+public:
+  std::vector<PluginLV2*> dsp;
+  std::vector<Ports> ports;
+  std::vector<std::vector<float> > out;
+  std::vector<float*> outs;
+
+  Instances(int k, uint32_t rate, uint32_t n) : dsp(k), ports(k), out(k), outs(k) {
+    uint32_t s = 7;
+    for (int i = 0; i < k; i++) {
+      float* v = ports[i].value;
+      memset(v, 0, sizeof(Ports));
+      v[BYPASS] = 1.0f;
+      v[MORPH] = 1.0f;
+      v[ENGINE] = 2.0f;
+      v[METER_MODE] = 1.0f;
+      for (int b = G1; b <= G11; b++) {
+        s = s * 1664525u + 1013904223u;
+        v[b] = float(s >> 8) * (24.0f / 16777216.0f) - 12.0f;
+      }
+      dsp[i] = matcheq_plugin();
+      if ((dsp[i]->version & PLUGINLV2_VERMAJOR_MASK) !=
+          (PLUGINLV2_VERSION & PLUGINLV2_VERMAJOR_MASK)) {
+        fprintf(stderr, "matcheq_plugin() has version %#x\n", dsp[i]->version);
+        exit(1);
+      }
+      dsp[i]->set_samplerate(rate, dsp[i]);
+      for (uint32_t p = 0; p < PORTS_SHARED; p++) {
+        if (p == EFFECTS_INPUT || p == EFFECTS_OUTPUT || p == CONTROL || p == NOTIFY)
+          continue;
+        dsp[i]->connect_ports(p, &v[p], dsp[i]);
+      }
+      dsp[i]->activate_plugin(true, dsp[i]);
+      // takes the engine from its port
+      dsp[i]->clear_state(dsp[i]);
+      out[i].resize(n);
+      outs[i] = out[i].data();
+    }
+  }
+  ~Instances() {
+    for (size_t i = 0; i < dsp.size(); i++) {
+      dsp[i]->activate_plugin(false, dsp[i]);
+      dsp[i]->delete_instance(dsp[i]);
+    }
+  }
+  // the change halfway through
+  void change() {
+    for (size_t i = 0; i < dsp.size(); i++) {
+      float* v = ports[i].value;
+      v[G1 + i % 11] = -v[G1 + i % 11];
+      v[MORPH] = 0.5f;
+    }
+  }
+};
+
+struct Result {
+  double ns;    // per channel and frame
+  double diff;  // largest difference to the separate runs
+};
+
+Result run(const Setup& su, uint32_t rate, uint32_t frames, bool batched,
+           std::vector<std::vector<float> >* ref)
+{
+  const int k = su.k;
+  const uint32_t n = su.n;
+  std::vector<std::vector<float> > in(k, std::vector<float>(n));
+  std::vector<float*> ins(k);
+  for (int i = 0; i < k; i++)
+    ins[i] = in[i].data();
+
+  double best = 0.0;
+  double diff = 0.0;
+  for (int r = 0; r < repeats; r++) {
+    Instances inst(k, rate, n);
+    BatchLV2* b = batched ? matcheq_batch(inst.dsp.data(), k) : NULL;
+    if (batched && !b) {
+      fprintf(stderr, "matcheq_batch() failed\n");
+      exit(1);
+    }
+    uint32_t s = 1;
+    double ns = 0.0;
+    uint32_t pos = 0;
+    for (uint32_t done = 0; done < frames; done += n) {
+      if (done <= frames / 2 && done + n > frames / 2)
+        inst.change();
+      for (int i = 0; i < k; i++) {
+        for (uint32_t j = 0; j < n; j++) {
+          s = s * 1664525u + 1013904223u;
+          in[i][j] = float(int32_t(s)) * (0.25f / 2147483648.0f);
+        }
+      }
+      const auto t0 = std::chrono::steady_clock::now();
+      if (b) {
+        b->batch_audio(n, ins.data(), inst.outs.data(), b);
+      } else {
+        for (int i = 0; i < k; i++)
+          inst.dsp[i]->mono_audio(n, ins[i], inst.outs[i], inst.dsp[i]);
+      }
+      const auto t1 = std::chrono::steady_clock::now();
+      ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+      // the output of the first round against the separate runs
+      if (r == 0 && ref) {
+        for (int i = 0; i < k; i++) {
+          for (uint32_t j = 0; j < n; j++) {
+            float& o = (*ref)[i][pos + j];
+            if (batched)
+              diff = std::max<double>(diff, std::fabs(o - inst.out[i][j]));
+            else
+              o = inst.out[i][j];
+          }
+        }
+        pos += n;
+      }
+    }
+    if (b)
+      b->delete_batch(b);
+    if (r == 0 || ns < best)
+      best = ns;
+  }
+  Result res = { best / (double(frames) * k), diff };
+  return res;
+}
+
+} // end namespace
+
+int main(int argc, char** argv)
+{
+  const uint32_t rate = (argc > 1) ? uint32_t(atoi(argv[1])) : 48000;
+  const uint32_t frames = (argc > 2) ? uint32_t(atoi(argv[2])) : 200000;
+
+  printf("batch of K instances against K mono_audio() calls, engine 2, %u Hz\n", rate);
+  printf("ns per channel and frame, best of %d x %u frames\n", repeats, frames);
+  printf("   K     n  separate     batch  speedup  max diff\n");
+  for (const Setup& su : setups) {
+    const uint32_t len = frames / su.n * su.n;
+    std::vector<std::vector<float> > ref(su.k, std::vector<float>(len));
+    const Result sep = run(su, rate, len, false, &ref);
+    const Result bat = run(su, rate, len, true, &ref);
+    printf("%4d  %4u  %8.1f  %8.1f  %6.2fx  %8.1e\n", su.k, su.n,
+           sep.ns, bat.ns, sep.ns / bat.ns, bat.diff);
+    fflush(stdout);
+  }
+  return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2014 Guitarix project MOD project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * --------------------------------------------------------------------------
+ */
+
+// ns/frame of the mono plugin through its LV2 run() at small buffers,
+// where the fixed cost of each run shows. Built and run by "make bench",
+// linked against the plugin objects of the tree.
+//
+//   bench_run [rate [frames]]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+
+#include "gx_matcheq.h"
+
+extern "C" const LV2_Descriptor* lv2_descriptor(uint32_t index);
+
+namespace {
+
+const uint32_t sizes[] = { 16, 32, 64 };
+const int engines[] = { 0, 1, 2, 5 };
+const int repeats = 4;   // the best of them counts
+
+double run_ns(const LV2_Descriptor* d, double rate, int engine,
+              uint32_t n, uint32_t frames)
+{
+  float ports[PORTS_SHARED];
+  memset(ports, 0, sizeof(ports));
+  ports[BYPASS] = 1.0f;
+  ports[MORPH] = 1.0f;
+  ports[ENGINE] = float(engine);
+  ports[METER_MODE] = 1.0f;
+  for (int b = G1; b <= G11; b++)
+    ports[b] = float((b - G1) % 5) - 2.0f;
+
+  LV2_Feature* features[] = { NULL };
+  LV2_Handle h = d->instantiate(d, rate, "", features);
+  if (!h) {
+    fprintf(stderr, "instantiate failed\n");
+    exit(1);
+  }
+  std::vector<float> in(n), out(n);
+  for (uint32_t p = 0; p < PORTS_SHARED; p++) {
+    if (p == EFFECTS_INPUT || p == EFFECTS_OUTPUT || p == CONTROL || p == NOTIFY)
+      continue;
+    d->connect_port(h, p, &ports[p]);
+  }
+  d->connect_port(h, EFFECTS_INPUT, in.data());
+  d->connect_port(h, EFFECTS_OUTPUT, out.data());
+  d->activate(h);
+
+  uint32_t s = 1;
+  double best = 0.0;
+  for (int r = 0; r <= repeats; r++) {
+    const auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t done = 0; done < frames; done += n) {
+      for (uint32_t i = 0; i < n; i++) {
+        s = s * 1664525u + 1013904223u;
+        in[i] = float(int32_t(s)) * (0.25f / 2147483648.0f);
+      }
+      d->run(h, n);
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    // the first round warms up
+    if (r == 1 || (r > 1 && ns < best))
+      best = ns;
+  }
+  d->deactivate(h);
+  d->cleanup(h);
+  return best / frames;
+}
+
+} // end namespace
+
+int main(int argc, char** argv)
+{
+  const double rate = (argc > 1) ? atof(argv[1]) : 48000.0;
+  const uint32_t frames = (argc > 2) ? uint32_t(atoi(argv[2])) : 2000000;
+  const LV2_Descriptor* d = lv2_descriptor(0);
+
+  printf("mono run(), %g Hz, ns/frame, best of %d x %u frames\n",
+         rate, repeats, frames);
+  printf("engine");
+  for (uint32_t n : sizes)
+    printf("    n=%-2u", n);
+  printf("\n");
+  for (int e : engines) {
+    printf("%-6d", e);
+    for (uint32_t n : sizes) {
+      printf("  %6.1f", run_ns(d, rate, e, n, frames));
+      fflush(stdout);
+    }
+    printf("\n");
+  }
+  return 0;
+}
@@ -29,6 +29,7 @@
 
 // forward declarations (need not be resolved for plugin definition)
 struct PluginLV2;
+struct BatchLV2;
 
 struct value_pair {
     const char *value_id;
@@ -45,13 +46,25 @@ typedef void (*clearstatefunc)(PluginLV2 *plugin);
 typedef void (*process_mono_audio) (int count, float *input, float *output, PluginLV2 *plugin);
 typedef void (*process_stereo_audio) (int count, float *input1, float *input2,
 				      float *output1, float *output2, PluginLV2 *plugin);
+typedef void (*process_multi_audio) (int count, int channels, float **inputs,
+				     float **outputs, PluginLV2 *plugin);
 typedef void (*registerfunc)(uint32_t port,void* data, PluginLV2 *plugin);
 typedef void (*deletefunc)(PluginLV2 *plugin);
+typedef uint32_t (*workpendingfunc)(PluginLV2 *plugin);
+typedef void (*workfunc)(uint32_t job, PluginLV2 *plugin);
+typedef int (*spectrumfunc)(float *levels, PluginLV2 *plugin);
+typedef int (*latencyfunc)(PluginLV2 *plugin);
 
 typedef PluginLV2 *(*plug) ();
 
+typedef void (*process_batch_audio)(int count, float **inputs, float **outputs, BatchLV2 *batch);
+typedef void (*batchclearfunc)(BatchLV2 *batch);
+typedef void (*batchdeletefunc)(BatchLV2 *batch);
+
+// 0x0600: mono_audio_block, multi_audio, the worker jobs, match_spectrum,
+// get_latency and match_detail
 #define PLUGINLV2_VERMAJOR_MASK 0xff00
-#define PLUGINLV2_VERSION       0x0500
+#define PLUGINLV2_VERSION       0x0600
 
 struct PluginLV2 {
     int version;	 // = PLUGINLV2_VERSION
@@ -62,6 +75,8 @@ struct PluginLV2 {
     // all function pointers in PluginLV2 can be independently set to 0
     process_mono_audio mono_audio; // function for mono audio processing
     process_stereo_audio stereo_audio; //function for stereo audio processing
+    process_mono_audio mono_audio_block; // optional mono_audio for large buffers
+    process_multi_audio multi_audio; // optional, 2 or more channels in lockstep
 
     inifunc set_samplerate; // called before audio processing and when rate changes
     activatefunc activate_plugin; // called when taking in / out of pressing chain
@@ -69,6 +84,26 @@ struct PluginLV2 {
     clearstatefunc clear_state;	// clear internal audio state; may be called
 				// before calling the process function
     deletefunc delete_instance; // delete this plugin instance
+    workpendingfunc work_pending; // audio thread: a job to schedule, 0 for none,
+				// called until it returns 0
+    workfunc work;		// run by the host worker thread for each job, 0 when there is none
+    workfunc work_response;	// called in the audio thread when that job is done
+    spectrumfunc match_spectrum; // audio thread: the number of a finished match
+				// capture, 0 for none, and its band levels in dB
+    latencyfunc get_latency;	// samples the output of the current engine is late
+    spectrumfunc match_detail;	// audio thread, after match_spectrum: the number
+				// of fractional octave levels of that capture, 0 for none
+};
+
+/*
+** many instances of a plugin in one call
+*/
+
+struct BatchLV2 {
+    process_batch_audio batch_audio; // inputs[k] and outputs[k] are the buffers
+				// of instance k, they may be the same
+    batchclearfunc clear_state;	// clear the audio state of all instances
+    batchdeletefunc delete_batch; // delete the batch, the instances stay
 };
 
 #endif /* !_GX_PLUGINLV2_H */
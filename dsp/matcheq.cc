@@ -4,144 +4,282 @@
 
 namespace matcheq {
 
+// input under this is silence, about half an LSB at 24 bit
+#define SILENCE_LEVEL 6e-8
+
+// fast path at equal band gains, see run_flat()
+#define FLAT_FADE_MS 50.0
+enum { FLAT_OFF, FLAT_ENTER, FLAT_ON, FLAT_LEAVE };
+
+class Batch;
+
+// The constants of the reference engine for sample rate fs, t[] are the
+// prewarped crossovers tan(bank_xover[] / fs). Known rates take them from
+// ref_table[], which the compiler fills in, and get a kernel of their own
+// with the constants folded into the code, see compute_ref(). Instances
+// only keep a pointer to them, see ref_acquire().
+#define REF_CONSTS 158
+
+struct RefConst {
+	double c[REF_CONSTS];
+};
+
+static constexpr RefConst ref_const(double fs, const double *t)
+{
+	RefConst k = {};
+	k.c[0] = std::min<double>(192000.0, std::max<double>(1.0, fs));
+	k.c[1] = (1.0 / k.c[0]);
+	k.c[2] = t[0];
+	k.c[3] = (1.0 / k.c[2]);
+	k.c[4] = (1.0 / (((k.c[3] + 1.0000000000000004) / k.c[2]) + 1.0));
+	k.c[5] = mydsp_faustpower2_f(k.c[2]);
+	k.c[6] = (1.0 / k.c[5]);
+	k.c[7] = (k.c[3] + 1.0);
+	k.c[8] = (0.0 - (1.0 / (k.c[7] * k.c[2])));
+	k.c[9] = (1.0 / k.c[7]);
+	k.c[10] = (1.0 - k.c[3]);
+	k.c[11] = (((k.c[3] + -1.0000000000000004) / k.c[2]) + 1.0);
+	k.c[12] = (2.0 * (1.0 - k.c[6]));
+	k.c[13] = (0.0 - (2.0 / k.c[5]));
+	k.c[14] = t[1];
+	k.c[15] = (1.0 / k.c[14]);
+	k.c[16] = (k.c[15] + 1.0);
+	k.c[17] = (1.0 / ((k.c[16] / k.c[14]) + 1.0));
+	k.c[18] = (1.0 - k.c[15]);
+	k.c[19] = (1.0 - (k.c[18] / k.c[14]));
+	k.c[20] = mydsp_faustpower2_f(k.c[14]);
+	k.c[21] = (1.0 / k.c[20]);
+	k.c[22] = (2.0 * (1.0 - k.c[21]));
+	k.c[23] = t[2];
+	k.c[24] = (1.0 / k.c[23]);
+	k.c[25] = (k.c[24] + 1.0);
+	k.c[26] = (1.0 / ((k.c[25] / k.c[23]) + 1.0));
+	k.c[27] = (1.0 - k.c[24]);
+	k.c[28] = (1.0 - (k.c[27] / k.c[23]));
+	k.c[29] = mydsp_faustpower2_f(k.c[23]);
+	k.c[30] = (1.0 / k.c[29]);
+	k.c[31] = (2.0 * (1.0 - k.c[30]));
+	k.c[32] = t[3];
+	k.c[33] = (1.0 / k.c[32]);
+	k.c[34] = (k.c[33] + 1.0);
+	k.c[35] = (1.0 / ((k.c[34] / k.c[32]) + 1.0));
+	k.c[36] = (1.0 - k.c[33]);
+	k.c[37] = (1.0 - (k.c[36] / k.c[32]));
+	k.c[38] = mydsp_faustpower2_f(k.c[32]);
+	k.c[39] = (1.0 / k.c[38]);
+	k.c[40] = (2.0 * (1.0 - k.c[39]));
+	k.c[41] = t[4];
+	k.c[42] = (1.0 / k.c[41]);
+	k.c[43] = (k.c[42] + 1.0);
+	k.c[44] = (1.0 / ((k.c[43] / k.c[41]) + 1.0));
+	k.c[45] = (1.0 - k.c[42]);
+	k.c[46] = (1.0 - (k.c[45] / k.c[41]));
+	k.c[47] = mydsp_faustpower2_f(k.c[41]);
+	k.c[48] = (1.0 / k.c[47]);
+	k.c[49] = (2.0 * (1.0 - k.c[48]));
+	k.c[50] = t[5];
+	k.c[51] = (1.0 / k.c[50]);
+	k.c[52] = (k.c[51] + 1.0);
+	k.c[53] = (1.0 / ((k.c[52] / k.c[50]) + 1.0));
+	k.c[54] = (1.0 - k.c[51]);
+	k.c[55] = (1.0 - (k.c[54] / k.c[50]));
+	k.c[56] = mydsp_faustpower2_f(k.c[50]);
+	k.c[57] = (1.0 / k.c[56]);
+	k.c[58] = (2.0 * (1.0 - k.c[57]));
+	k.c[59] = t[6];
+	k.c[60] = (1.0 / k.c[59]);
+	k.c[61] = (k.c[60] + 1.0);
+	k.c[62] = (1.0 / ((k.c[61] / k.c[59]) + 1.0));
+	k.c[63] = (1.0 - k.c[60]);
+	k.c[64] = (1.0 - (k.c[63] / k.c[59]));
+	k.c[65] = mydsp_faustpower2_f(k.c[59]);
+	k.c[66] = (1.0 / k.c[65]);
+	k.c[67] = (2.0 * (1.0 - k.c[66]));
+	k.c[68] = t[7];
+	k.c[69] = (1.0 / k.c[68]);
+	k.c[70] = (k.c[69] + 1.0);
+	k.c[71] = (1.0 / ((k.c[70] / k.c[68]) + 1.0));
+	k.c[72] = (1.0 - k.c[69]);
+	k.c[73] = (1.0 - (k.c[72] / k.c[68]));
+	k.c[74] = mydsp_faustpower2_f(k.c[68]);
+	k.c[75] = (1.0 / k.c[74]);
+	k.c[76] = (2.0 * (1.0 - k.c[75]));
+	k.c[77] = t[8];
+	k.c[78] = (1.0 / k.c[77]);
+	k.c[79] = (k.c[78] + 1.0);
+	k.c[80] = (1.0 / ((k.c[79] / k.c[77]) + 1.0));
+	k.c[81] = (1.0 - k.c[78]);
+	k.c[82] = (1.0 - (k.c[81] / k.c[77]));
+	k.c[83] = mydsp_faustpower2_f(k.c[77]);
+	k.c[84] = (1.0 / k.c[83]);
+	k.c[85] = (2.0 * (1.0 - k.c[84]));
+	k.c[86] = t[9];
+	k.c[87] = (1.0 / k.c[86]);
+	k.c[88] = (k.c[87] + 1.0);
+	k.c[89] = (1.0 / ((k.c[88] / k.c[86]) + 1.0));
+	k.c[90] = (1.0 - k.c[87]);
+	k.c[91] = (1.0 - (k.c[90] / k.c[86]));
+	k.c[92] = mydsp_faustpower2_f(k.c[86]);
+	k.c[93] = (1.0 / k.c[92]);
+	k.c[94] = (2.0 * (1.0 - k.c[93]));
+	k.c[95] = (1.0 / (((k.c[15] + 1.0000000000000004) / k.c[14]) + 1.0));
+	k.c[96] = (1.0 / (k.c[14] * k.c[16]));
+	k.c[97] = (0.0 - k.c[96]);
+	k.c[98] = (k.c[18] / k.c[16]);
+	k.c[99] = (((k.c[15] + -1.0000000000000004) / k.c[14]) + 1.0);
+	k.c[100] = (0.0 - (2.0 / k.c[20]));
+	k.c[101] = (1.0 / (((k.c[24] + 1.0000000000000004) / k.c[23]) + 1.0));
+	k.c[102] = (1.0 / (k.c[23] * k.c[25]));
+	k.c[103] = (1.0 / k.c[16]);
+	k.c[104] = (0.0 - k.c[102]);
+	k.c[105] = (k.c[27] / k.c[25]);
+	k.c[106] = (((k.c[24] + -1.0000000000000004) / k.c[23]) + 1.0);
+	k.c[107] = (0.0 - (2.0 / k.c[29]));
+	k.c[108] = (1.0 / (((k.c[33] + 1.0000000000000004) / k.c[32]) + 1.0));
+	k.c[109] = (1.0 / (k.c[32] * k.c[34]));
+	k.c[110] = (1.0 / k.c[25]);
+	k.c[111] = (0.0 - k.c[109]);
+	k.c[112] = (k.c[36] / k.c[34]);
+	k.c[113] = (((k.c[33] + -1.0000000000000004) / k.c[32]) + 1.0);
+	k.c[114] = (0.0 - (2.0 / k.c[38]));
+	k.c[115] = (1.0 / (((k.c[42] + 1.0000000000000004) / k.c[41]) + 1.0));
+	k.c[116] = (1.0 / (k.c[41] * k.c[43]));
+	k.c[117] = (1.0 / k.c[34]);
+	k.c[118] = (0.0 - k.c[116]);
+	k.c[119] = (k.c[45] / k.c[43]);
+	k.c[120] = (((k.c[42] + -1.0000000000000004) / k.c[41]) + 1.0);
+	k.c[121] = (0.0 - (2.0 / k.c[47]));
+	k.c[122] = (1.0 / (((k.c[51] + 1.0000000000000004) / k.c[50]) + 1.0));
+	k.c[123] = (1.0 / (k.c[50] * k.c[52]));
+	k.c[124] = (1.0 / k.c[43]);
+	k.c[125] = (0.0 - k.c[123]);
+	k.c[126] = (k.c[54] / k.c[52]);
+	k.c[127] = (((k.c[51] + -1.0000000000000004) / k.c[50]) + 1.0);
+	k.c[128] = (0.0 - (2.0 / k.c[56]));
+	k.c[129] = (1.0 / (((k.c[60] + 1.0000000000000004) / k.c[59]) + 1.0));
+	k.c[130] = (1.0 / (k.c[59] * k.c[61]));
+	k.c[131] = (1.0 / k.c[52]);
+	k.c[132] = (0.0 - k.c[130]);
+	k.c[133] = (k.c[63] / k.c[61]);
+	k.c[134] = (((k.c[60] + -1.0000000000000004) / k.c[59]) + 1.0);
+	k.c[135] = (0.0 - (2.0 / k.c[65]));
+	k.c[136] = (1.0 / (((k.c[69] + 1.0000000000000004) / k.c[68]) + 1.0));
+	k.c[137] = (1.0 / (k.c[68] * k.c[70]));
+	k.c[138] = (1.0 / k.c[61]);
+	k.c[139] = (0.0 - k.c[137]);
+	k.c[140] = (k.c[72] / k.c[70]);
+	k.c[141] = (((k.c[69] + -1.0000000000000004) / k.c[68]) + 1.0);
+	k.c[142] = (0.0 - (2.0 / k.c[74]));
+	k.c[143] = (1.0 / (((k.c[78] + 1.0000000000000004) / k.c[77]) + 1.0));
+	k.c[144] = (1.0 / (k.c[77] * k.c[79]));
+	k.c[145] = (1.0 / k.c[70]);
+	k.c[146] = (0.0 - k.c[144]);
+	k.c[147] = (k.c[81] / k.c[79]);
+	k.c[148] = (((k.c[78] + -1.0000000000000004) / k.c[77]) + 1.0);
+	k.c[149] = (0.0 - (2.0 / k.c[83]));
+	k.c[150] = (1.0 / (((k.c[87] + 1.0000000000000004) / k.c[86]) + 1.0));
+	k.c[151] = (1.0 / (k.c[86] * k.c[88]));
+	k.c[152] = (1.0 / k.c[79]);
+	k.c[153] = (0.0 - k.c[151]);
+	k.c[154] = (k.c[90] / k.c[88]);
+	k.c[155] = (((k.c[87] + -1.0000000000000004) / k.c[86]) + 1.0);
+	k.c[156] = (0.0 - (2.0 / k.c[92]));
+	k.c[157] = (1.0 / k.c[88]);
+	return k;
+}
+
+static constexpr RefConst ref_table[BANK_RATES] = {
+	ref_const(bank_rates[0], bank_tan[0]), ref_const(bank_rates[1], bank_tan[1]),
+	ref_const(bank_rates[2], bank_tan[2]), ref_const(bank_rates[3], bank_tan[3]),
+	ref_const(bank_rates[4], bank_tan[4])
+};
+
+// all constants of the engines at one sample rate
+struct RateConst {
+	BankConst bank;   // of fBank, engine 1, 2 and 5
+	RefConst ref;     // of the reference engine, as in ref_table[] at the known rates
+};
+
+// The constants are shared by all instances at a rate, in a list guarded
+// by ref_lock; the last instance to go frees them.
+struct RefShared {
+	RateConst k;
+	double fs;
+	int users;
+	RefShared *next;
+};
+
+static RefShared *ref_shared = 0;
+static std::mutex ref_lock;
+
+static const RateConst *ref_acquire(double fs)
+{
+	std::lock_guard<std::mutex> lock(ref_lock);
+	RefShared *e = ref_shared;
+	while (e && e->fs != fs) e = e->next;
+	if (!e) {
+		const int r = bank_rate(fs);
+		e = mem_new<RefShared>(1);
+		if (r < 0) {
+			double t[BANK_STAGES];
+			for (int s = 0; s < BANK_STAGES; s++) t[s] = std::tan(bank_xover[s] / fs);
+			e->k.ref = ref_const(fs, t);
+		} else {
+			e->k.ref = ref_table[r];
+		}
+		bank_const(e->k.bank, fs);
+		e->fs = fs;
+		e->users = 0;
+		e->next = ref_shared;
+		ref_shared = e;
+	}
+	e->users++;
+	return &e->k;
+}
+
+static void ref_release(const RateConst *k)
+{
+	std::lock_guard<std::mutex> lock(ref_lock);
+	for (RefShared **e = &ref_shared; *e; e = &(*e)->next) {
+		if (&(*e)->k != k) continue;
+		RefShared *d = *e;
+		if (--d->users == 0) {
+			*e = d->next;
+			mem_put(d);
+		}
+		return;
+	}
+}
+
 class Dsp: public PluginLV2 {
 private:
-	uint32_t fSamplingFreq;
-	FAUSTFLOAT fVslider0;
-	FAUSTFLOAT	*fVslider0_;
-	double fRec0[2];
-	double fConst0;
-	double fConst1;
-	FAUSTFLOAT fVslider1;
-	FAUSTFLOAT	*fVslider1_;
+	// per-sample state of the reference engine, in one block in the order
+	// compute_ref() first touches it
+	double fRec0[2] __attribute__((aligned(64)));
+	int iRec2[2];
 	double fRec4[2];
-	double fConst2;
-	double fConst3;
-	double fConst4;
-	double fConst5;
-	double fConst6;
-	double fConst7;
-	double fConst8;
-	FAUSTFLOAT fVslider2;
-	FAUSTFLOAT	*fVslider2_;
 	double fRec16[2];
 	double fVec0[2];
-	double fConst9;
-	double fConst10;
 	double fRec15[2];
-	double fConst11;
-	double fConst12;
 	double fRec14[3];
-	double fConst13;
-	double fConst14;
-	double fConst15;
-	double fConst16;
-	double fConst17;
-	double fConst18;
-	double fConst19;
-	double fConst20;
-	double fConst21;
-	double fConst22;
 	double fRec13[3];
-	double fConst23;
-	double fConst24;
-	double fConst25;
-	double fConst26;
-	double fConst27;
-	double fConst28;
-	double fConst29;
-	double fConst30;
-	double fConst31;
 	double fRec12[3];
-	double fConst32;
-	double fConst33;
-	double fConst34;
-	double fConst35;
-	double fConst36;
-	double fConst37;
-	double fConst38;
-	double fConst39;
-	double fConst40;
 	double fRec11[3];
-	double fConst41;
-	double fConst42;
-	double fConst43;
-	double fConst44;
-	double fConst45;
-	double fConst46;
-	double fConst47;
-	double fConst48;
-	double fConst49;
 	double fRec10[3];
-	double fConst50;
-	double fConst51;
-	double fConst52;
-	double fConst53;
-	double fConst54;
-	double fConst55;
-	double fConst56;
-	double fConst57;
-	double fConst58;
 	double fRec9[3];
-	double fConst59;
-	double fConst60;
-	double fConst61;
-	double fConst62;
-	double fConst63;
-	double fConst64;
-	double fConst65;
-	double fConst66;
-	double fConst67;
 	double fRec8[3];
-	double fConst68;
-	double fConst69;
-	double fConst70;
-	double fConst71;
-	double fConst72;
-	double fConst73;
-	double fConst74;
-	double fConst75;
-	double fConst76;
 	double fRec7[3];
-	double fConst77;
-	double fConst78;
-	double fConst79;
-	double fConst80;
-	double fConst81;
-	double fConst82;
-	double fConst83;
-	double fConst84;
-	double fConst85;
 	double fRec6[3];
-	double fConst86;
-	double fConst87;
-	double fConst88;
-	double fConst89;
-	double fConst90;
-	double fConst91;
-	double fConst92;
-	double fConst93;
-	double fConst94;
 	double fRec5[3];
 	double fRec1[2];
-	int iRec2[2];
 	double fRec3[2];
-	FAUSTFLOAT fVbargraph0;
-	FAUSTFLOAT	*fVbargraph0_;
-	FAUSTFLOAT fVslider3;
-	FAUSTFLOAT	*fVslider3_;
+	int iRec18[2];
 	double fRec20[2];
-	double fConst95;
-	double fConst96;
 	double fRec32[2];
 	double fRec31[3];
 	double fVec1[2];
-	double fConst97;
-	double fConst98;
 	double fRec30[2];
-	double fConst99;
 	double fRec29[3];
-	double fConst100;
 	double fRec28[3];
 	double fRec27[3];
 	double fRec26[3];
@@ -151,25 +289,14 @@ private:
 	double fRec22[3];
 	double fRec21[3];
 	double fRec17[2];
-	int iRec18[2];
 	double fRec19[2];
-	FAUSTFLOAT fVbargraph1;
-	FAUSTFLOAT	*fVbargraph1_;
-	FAUSTFLOAT fVslider4;
-	FAUSTFLOAT	*fVslider4_;
+	int iRec34[2];
 	double fRec36[2];
-	double fConst101;
-	double fConst102;
-	double fConst103;
 	double fRec47[2];
 	double fRec46[3];
 	double fVec2[2];
-	double fConst104;
-	double fConst105;
 	double fRec45[2];
-	double fConst106;
 	double fRec44[3];
-	double fConst107;
 	double fRec43[3];
 	double fRec42[3];
 	double fRec41[3];
@@ -178,25 +305,14 @@ private:
 	double fRec38[3];
 	double fRec37[3];
 	double fRec33[2];
-	int iRec34[2];
 	double fRec35[2];
-	FAUSTFLOAT fVbargraph2;
-	FAUSTFLOAT	*fVbargraph2_;
-	FAUSTFLOAT fVslider5;
-	FAUSTFLOAT	*fVslider5_;
+	int iRec49[2];
 	double fRec51[2];
-	double fConst108;
-	double fConst109;
-	double fConst110;
 	double fRec61[2];
 	double fRec60[3];
 	double fVec3[2];
-	double fConst111;
-	double fConst112;
 	double fRec59[2];
-	double fConst113;
 	double fRec58[3];
-	double fConst114;
 	double fRec57[3];
 	double fRec56[3];
 	double fRec55[3];
@@ -204,155 +320,108 @@ private:
 	double fRec53[3];
 	double fRec52[3];
 	double fRec48[2];
-	int iRec49[2];
 	double fRec50[2];
-	FAUSTFLOAT fVbargraph3;
-	FAUSTFLOAT	*fVbargraph3_;
-	FAUSTFLOAT fVslider6;
-	FAUSTFLOAT	*fVslider6_;
+	int iRec63[2];
 	double fRec65[2];
-	double fConst115;
-	double fConst116;
-	double fConst117;
 	double fRec74[2];
 	double fRec73[3];
 	double fVec4[2];
-	double fConst118;
-	double fConst119;
 	double fRec72[2];
-	double fConst120;
 	double fRec71[3];
-	double fConst121;
 	double fRec70[3];
 	double fRec69[3];
 	double fRec68[3];
 	double fRec67[3];
 	double fRec66[3];
 	double fRec62[2];
-	int iRec63[2];
 	double fRec64[2];
-	FAUSTFLOAT fVbargraph4;
-	FAUSTFLOAT	*fVbargraph4_;
-	FAUSTFLOAT fVslider7;
-	FAUSTFLOAT	*fVslider7_;
+	int iRec76[2];
 	double fRec78[2];
-	double fConst122;
-	double fConst123;
-	double fConst124;
 	double fRec86[2];
 	double fRec85[3];
 	double fVec5[2];
-	double fConst125;
-	double fConst126;
 	double fRec84[2];
-	double fConst127;
 	double fRec83[3];
-	double fConst128;
 	double fRec82[3];
 	double fRec81[3];
 	double fRec80[3];
 	double fRec79[3];
 	double fRec75[2];
-	int iRec76[2];
 	double fRec77[2];
-	FAUSTFLOAT fVbargraph5;
-	FAUSTFLOAT	*fVbargraph5_;
-	FAUSTFLOAT fVslider8;
-	FAUSTFLOAT	*fVslider8_;
+	int iRec88[2];
 	double fRec90[2];
-	double fConst129;
-	double fConst130;
-	double fConst131;
 	double fRec97[2];
 	double fRec96[3];
 	double fVec6[2];
-	double fConst132;
-	double fConst133;
 	double fRec95[2];
-	double fConst134;
 	double fRec94[3];
-	double fConst135;
 	double fRec93[3];
 	double fRec92[3];
 	double fRec91[3];
 	double fRec87[2];
-	int iRec88[2];
 	double fRec89[2];
-	FAUSTFLOAT fVbargraph6;
-	FAUSTFLOAT	*fVbargraph6_;
-	FAUSTFLOAT fVslider9;
-	FAUSTFLOAT	*fVslider9_;
+	int iRec99[2];
 	double fRec101[2];
-	double fConst136;
-	double fConst137;
-	double fConst138;
 	double fRec107[2];
 	double fRec106[3];
 	double fVec7[2];
-	double fConst139;
-	double fConst140;
 	double fRec105[2];
-	double fConst141;
 	double fRec104[3];
-	double fConst142;
 	double fRec103[3];
 	double fRec102[3];
 	double fRec98[2];
-	int iRec99[2];
 	double fRec100[2];
-	FAUSTFLOAT fVbargraph7;
-	FAUSTFLOAT	*fVbargraph7_;
-	FAUSTFLOAT fVslider10;
-	FAUSTFLOAT	*fVslider10_;
+	int iRec109[2];
 	double fRec111[2];
-	double fConst143;
-	double fConst144;
-	double fConst145;
 	double fRec116[2];
 	double fRec115[3];
 	double fVec8[2];
-	double fConst146;
-	double fConst147;
 	double fRec114[2];
-	double fConst148;
 	double fRec113[3];
-	double fConst149;
 	double fRec112[3];
 	double fRec108[2];
-	int iRec109[2];
 	double fRec110[2];
-	FAUSTFLOAT fVbargraph8;
-	FAUSTFLOAT	*fVbargraph8_;
-	double fConst150;
-	FAUSTFLOAT fVslider11;
-	FAUSTFLOAT	*fVslider11_;
+	int iRec118[2];
 	double fRec120[2];
-	double fConst151;
-	double fConst152;
 	double fRec124[2];
 	double fRec123[3];
 	double fVec9[2];
-	double fConst153;
-	double fConst154;
 	double fRec122[2];
-	double fConst155;
 	double fRec121[3];
-	double fConst156;
 	double fRec117[2];
-	int iRec118[2];
 	double fRec119[2];
-	FAUSTFLOAT fVbargraph9;
-	FAUSTFLOAT	*fVbargraph9_;
-	FAUSTFLOAT fVslider12;
-	FAUSTFLOAT	*fVslider12_;
+	int iRec126[2];
 	double fRec128[2];
-	double fConst157;
 	double fRec130[2];
 	double fRec129[3];
 	double fRec125[2];
-	int iRec126[2];
 	double fRec127[2];
-	FAUSTFLOAT fVbargraph10;
+	uint32_t fSamplingFreq __attribute__((aligned(64)));
+	int fRate;          // index into bank_rates[], -1 for the others
+	const RateConst *fRef;  // constants at fSamplingFreq, shared
+	FAUSTFLOAT	*fVslider0_;
+	FAUSTFLOAT	*fVslider1_;
+	FAUSTFLOAT	*fVslider2_;
+	FAUSTFLOAT	*fVbargraph0_;
+	FAUSTFLOAT	*fVslider3_;
+	FAUSTFLOAT	*fVbargraph1_;
+	FAUSTFLOAT	*fVslider4_;
+	FAUSTFLOAT	*fVbargraph2_;
+	FAUSTFLOAT	*fVslider5_;
+	FAUSTFLOAT	*fVbargraph3_;
+	FAUSTFLOAT	*fVslider6_;
+	FAUSTFLOAT	*fVbargraph4_;
+	FAUSTFLOAT	*fVslider7_;
+	FAUSTFLOAT	*fVbargraph5_;
+	FAUSTFLOAT	*fVslider8_;
+	FAUSTFLOAT	*fVbargraph6_;
+	FAUSTFLOAT	*fVslider9_;
+	FAUSTFLOAT	*fVbargraph7_;
+	FAUSTFLOAT	*fVslider10_;
+	FAUSTFLOAT	*fVbargraph8_;
+	FAUSTFLOAT	*fVslider11_;
+	FAUSTFLOAT	*fVbargraph9_;
+	FAUSTFLOAT	*fVslider12_;
 	FAUSTFLOAT	*fVbargraph10_;
 	double _power0;
 	double _power1;
@@ -365,21 +434,121 @@ private:
 	double _power8;
 	double _power9;
 	double _power10;
+	// last meter readings and their dB values
+	double fPowerLast[BANK_BANDS];
+	FAUSTFLOAT fPowerDb[BANK_BANDS];
     double db_zero;
 	FAUSTFLOAT bypass;
 	FAUSTFLOAT	*bypass_;
     double anti_denormal;
+	FAUSTFLOAT engine;
+	FAUSTFLOAT	*engine_;
+	int fEngine;
+	SimdBank fBank;
+	BankRamp fRamp;
+	FirEq fFir;
+	FitEq fFit;
+	SpecAnalysis fSpec;
+	FAUSTFLOAT	*latency_;
+	FAUSTFLOAT	*match1_;
+	FAUSTFLOAT	*match2_;
+	FAUSTFLOAT	*analysis_;
+	FAUSTFLOAT	*skipped_;
+	// silence detection, see idle()
+	int fSilent;        // silent input samples since the last sound
+	int fTail;          // samples the lowest split needs to decay
+	bool fIdle;         // the kernel is stopped
+	uint32_t fSkipped;  // blocks not computed
+	FAUSTFLOAT	*flat_;
+	// fast path at equal band gains, see run_flat()
+	int fFlat;              // FLAT_OFF .. FLAT_LEAVE
+	int fFlatLeft;          // samples left of the transition
+	int fFlatFade;
+	bool fFlatThrough;      // without the allpasses
+	BankParam fFlatParam;   // of the flat path, for the way out
+	FAUSTFLOAT	*meter_;
+	FAUSTFLOAT	*meter_ms_;
+	FAUSTFLOAT fMeterMs;    // of the window of fBank, see set_meter()
+	// match captures, see capture()
+	int fMatch;             // capture running, 1 for MATCH1, 2 for MATCH2, or 0
+	int fMatchDone;         // capture finished and not read yet
+	double fMatchFrames;    // frames in fBank.energy()
+	float fMatchDb[BANK_BANDS];  // levels of the finished capture, G1 .. G11
+	int fMatchWait;         // capture finished, fSpec works on its levels
+	int fSpecDone;          // levels in fSpecDb go with fMatchDone
+	float fSpecDb[SPECTRUM_MAX];
+	FAUSTFLOAT	*resolution_;
+	bool fPlaced;           // in memory of the caller, see place()
+	// port values of the generated code, the ports are read through the
+	// pointers above
+	FAUSTFLOAT fVslider0;
+	FAUSTFLOAT fVslider1;
+	FAUSTFLOAT fVslider2;
+	FAUSTFLOAT fVbargraph0;
+	FAUSTFLOAT fVslider3;
+	FAUSTFLOAT fVbargraph1;
+	FAUSTFLOAT fVslider4;
+	FAUSTFLOAT fVbargraph2;
+	FAUSTFLOAT fVslider5;
+	FAUSTFLOAT fVbargraph3;
+	FAUSTFLOAT fVslider6;
+	FAUSTFLOAT fVbargraph4;
+	FAUSTFLOAT fVslider7;
+	FAUSTFLOAT fVbargraph5;
+	FAUSTFLOAT fVslider8;
+	FAUSTFLOAT fVbargraph6;
+	FAUSTFLOAT fVslider9;
+	FAUSTFLOAT fVbargraph7;
+	FAUSTFLOAT fVslider10;
+	FAUSTFLOAT fVbargraph8;
+	FAUSTFLOAT fVslider11;
+	FAUSTFLOAT fVbargraph9;
+	FAUSTFLOAT fVslider12;
+	FAUSTFLOAT fVbargraph10;
 
 	void connect(uint32_t port,void* data);
+	inline FAUSTFLOAT meter_db(int band, double power);
+	inline void set_ramps();
+	inline void bank_power();
+	inline void report();
+	inline void report_idle();
+	inline int latency() const;
+	inline bool idle(int count, int channels, FAUSTFLOAT **inputs, FAUSTFLOAT **outputs);
+	inline void settle(int count, int channels, FAUSTFLOAT **outputs, int delay);
+	inline void run_bank(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0,
+	                     const BankParam& p, bool block);
+	inline void run_flat(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0,
+	                     const BankParam& p, bool block, bool ok);
 	void clear_state_f();
 	void init(uint32_t samplingFreq);
-	void compute(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0);
+	template <int R, int M>
+	inline void compute_ref(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0);
+	template <int M>
+	inline void compute_ref_rate(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0);
+	template <int M>
+	inline void ref_meter(int band, double y, double& env, int& count, double& hold, double floor);
+	inline int set_meter(bool matching);
+	inline bool capture();
+	void compute(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0, bool block);
+	void compute_multi(int count, int channels, FAUSTFLOAT **inputs, FAUSTFLOAT **outputs);
 
 	static void clear_state_f_static(PluginLV2*);
 	static void init_static(uint32_t samplingFreq, PluginLV2*);
 	static void compute_static(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0, PluginLV2*);
+	static void compute_block_static(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0, PluginLV2*);
+	static void compute_multi_static(int count, int channels, FAUSTFLOAT **inputs,
+	                                 FAUSTFLOAT **outputs, PluginLV2*);
 	static void del_instance(PluginLV2 *p);
+	static int activate_static(bool start, PluginLV2 *p);
+	static uint32_t work_pending_static(PluginLV2 *p);
+	static void work_static(uint32_t job, PluginLV2 *p);
+	static void work_response_static(uint32_t job, PluginLV2 *p);
 	static void connect_static(uint32_t port,void* data, PluginLV2 *p);
+	static int match_spectrum_static(float *levels, PluginLV2 *p);
+	static int match_detail_static(float *levels, PluginLV2 *p);
+	static int get_latency_static(PluginLV2 *p);
+	friend class Batch;
+	friend PluginLV2 *place(void *mem);
 public:
 	Dsp();
 	~Dsp();
@@ -388,20 +557,57 @@ public:
 
 
 Dsp::Dsp()
-	: PluginLV2() {
+	: PluginLV2(),
+	  fRate(-1),
+	  fRef(0),
+	  engine_(0),
+	  latency_(0),
+	  match1_(0),
+	  match2_(0),
+	  analysis_(0),
+	  skipped_(0),
+	  fSilent(0),
+	  fTail(0),
+	  fIdle(false),
+	  fSkipped(0),
+	  flat_(0),
+	  fFlat(FLAT_OFF),
+	  fFlatLeft(0),
+	  fFlatFade(1),
+	  fFlatThrough(false),
+	  meter_(0),
+	  meter_ms_(0),
+	  fMeterMs(-1),
+	  fMatch(0),
+	  fMatchDone(0),
+	  fMatchFrames(0),
+	  fMatchWait(0),
+	  fSpecDone(0),
+	  resolution_(0),
+	  fPlaced(false) {
 	version = PLUGINLV2_VERSION;
 	id = "matcheq";
 	name = N_("Graphic EQ");
 	mono_audio = compute_static;
 	stereo_audio = 0;
+	// the time blocked kernel only pays off with 4 lanes (AVX)
+	mono_audio_block = BANK_BLOCK_MODE ? compute_block_static : 0;
+	multi_audio = compute_multi_static;
 	set_samplerate = init_static;
-	activate_plugin = 0;
+	activate_plugin = activate_static;
 	connect_ports = connect_static;
 	clear_state = clear_state_f_static;
 	delete_instance = del_instance;
+	work_pending = work_pending_static;
+	work = work_static;
+	work_response = work_response_static;
+	match_spectrum = match_spectrum_static;
+	match_detail = match_detail_static;
+	get_latency = get_latency_static;
 }
 
 Dsp::~Dsp() {
+	if (fRef) ref_release(fRef);
 }
 
 inline void Dsp::clear_state_f()
@@ -547,6 +753,20 @@ inline void Dsp::clear_state_f()
 	for (int l138 = 0; (l138 < 2); l138 = (l138 + 1)) fRec125[l138] = 0.0;
 	for (int l139 = 0; (l139 < 2); l139 = (l139 + 1)) iRec126[l139] = 0;
 	for (int l140 = 0; (l140 < 2); l140 = (l140 + 1)) fRec127[l140] = 0.0;
+	// the engine is only switched when the state is cleared
+	fEngine = engine_ ? std::min<int>(std::max<int>(int(*engine_), 0), 5) : 1;
+	// linear phase and fitted need the worker thread for the filter design,
+	// multirate a sample rate of at least 2 * MR_RATE
+	if ((fEngine == 3 && !(work && fFir.ready())) || (fEngine == 4 && !work) ||
+	    (fEngine == 5 && !fBank.multirate())) fEngine = 2;
+	fBank.clear_state();
+	fRamp.clear();
+	fFir.clear_state();
+	fFit.clear_state();
+	fSilent = 0;
+	fIdle = false;
+	fFlat = FLAT_OFF;
+	fFlatLeft = 0;
 }
 
 void Dsp::clear_state_f_static(PluginLV2 *p)
@@ -557,164 +777,11 @@ void Dsp::clear_state_f_static(PluginLV2 *p)
 inline void Dsp::init(uint32_t samplingFreq)
 {
 	fSamplingFreq = samplingFreq;
-	fConst0 = std::min<double>(192000.0, std::max<double>(1.0, double(fSamplingFreq)));
-	fConst1 = (1.0 / fConst0);
-	fConst2 = std::tan((56894.242956511152 / fConst0));
-	fConst3 = (1.0 / fConst2);
-	fConst4 = (1.0 / (((fConst3 + 1.0000000000000004) / fConst2) + 1.0));
-	fConst5 = mydsp_faustpower2_f(fConst2);
-	fConst6 = (1.0 / fConst5);
-	fConst7 = (fConst3 + 1.0);
-	fConst8 = (0.0 - (1.0 / (fConst7 * fConst2)));
-	fConst9 = (1.0 / fConst7);
-	fConst10 = (1.0 - fConst3);
-	fConst11 = (((fConst3 + -1.0000000000000004) / fConst2) + 1.0);
-	fConst12 = (2.0 * (1.0 - fConst6));
-	fConst13 = (0.0 - (2.0 / fConst5));
-	fConst14 = std::tan((35763.890768466204 / fConst0));
-	fConst15 = (1.0 / fConst14);
-	fConst16 = (fConst15 + 1.0);
-	fConst17 = (1.0 / ((fConst16 / fConst14) + 1.0));
-	fConst18 = (1.0 - fConst15);
-	fConst19 = (1.0 - (fConst18 / fConst14));
-	fConst20 = mydsp_faustpower2_f(fConst14);
-	fConst21 = (1.0 / fConst20);
-	fConst22 = (2.0 * (1.0 - fConst21));
-	fConst23 = std::tan((17771.989641357461 / fConst0));
-	fConst24 = (1.0 / fConst23);
-	fConst25 = (fConst24 + 1.0);
-	fConst26 = (1.0 / ((fConst25 / fConst23) + 1.0));
-	fConst27 = (1.0 - fConst24);
-	fConst28 = (1.0 - (fConst27 / fConst23));
-	fConst29 = mydsp_faustpower2_f(fConst23);
-	fConst30 = (1.0 / fConst29);
-	fConst31 = (2.0 * (1.0 - fConst30));
-	fConst32 = std::tan((8884.4240243519343 / fConst0));
-	fConst33 = (1.0 / fConst32);
-	fConst34 = (fConst33 + 1.0);
-	fConst35 = (1.0 / ((fConst34 / fConst32) + 1.0));
-	fConst36 = (1.0 - fConst33);
-	fConst37 = (1.0 - (fConst36 / fConst32));
-	fConst38 = mydsp_faustpower2_f(fConst32);
-	fConst39 = (1.0 / fConst38);
-	fConst40 = (2.0 * (1.0 - fConst39));
-	fConst41 = std::tan((4442.2120121759672 / fConst0));
-	fConst42 = (1.0 / fConst41);
-	fConst43 = (fConst42 + 1.0);
-	fConst44 = (1.0 / ((fConst43 / fConst41) + 1.0));
-	fConst45 = (1.0 - fConst42);
-	fConst46 = (1.0 - (fConst45 / fConst41));
-	fConst47 = mydsp_faustpower2_f(fConst41);
-	fConst48 = (1.0 / fConst47);
-	fConst49 = (2.0 * (1.0 - fConst48));
-	fConst50 = std::tan((2221.1060060879836 / fConst0));
-	fConst51 = (1.0 / fConst50);
-	fConst52 = (fConst51 + 1.0);
-	fConst53 = (1.0 / ((fConst52 / fConst50) + 1.0));
-	fConst54 = (1.0 - fConst51);
-	fConst55 = (1.0 - (fConst54 / fConst50));
-	fConst56 = mydsp_faustpower2_f(fConst50);
-	fConst57 = (1.0 / fConst56);
-	fConst58 = (2.0 * (1.0 - fConst57));
-	fConst59 = std::tan((1112.1237993707869 / fConst0));
-	fConst60 = (1.0 / fConst59);
-	fConst61 = (fConst60 + 1.0);
-	fConst62 = (1.0 / ((fConst61 / fConst59) + 1.0));
-	fConst63 = (1.0 - fConst60);
-	fConst64 = (1.0 - (fConst63 / fConst59));
-	fConst65 = mydsp_faustpower2_f(fConst59);
-	fConst66 = (1.0 / fConst65);
-	fConst67 = (2.0 * (1.0 - fConst66));
-	fConst68 = std::tan((556.06189968539343 / fConst0));
-	fConst69 = (1.0 / fConst68);
-	fConst70 = (fConst69 + 1.0);
-	fConst71 = (1.0 / ((fConst70 / fConst68) + 1.0));
-	fConst72 = (1.0 - fConst69);
-	fConst73 = (1.0 - (fConst72 / fConst68));
-	fConst74 = mydsp_faustpower2_f(fConst68);
-	fConst75 = (1.0 / fConst74);
-	fConst76 = (2.0 * (1.0 - fConst75));
-	fConst77 = std::tan((276.46015351590177 / fConst0));
-	fConst78 = (1.0 / fConst77);
-	fConst79 = (fConst78 + 1.0);
-	fConst80 = (1.0 / ((fConst79 / fConst77) + 1.0));
-	fConst81 = (1.0 - fConst78);
-	fConst82 = (1.0 - (fConst81 / fConst77));
-	fConst83 = mydsp_faustpower2_f(fConst77);
-	fConst84 = (1.0 / fConst83);
-	fConst85 = (2.0 * (1.0 - fConst84));
-	fConst86 = std::tan((138.23007675795088 / fConst0));
-	fConst87 = (1.0 / fConst86);
-	fConst88 = (fConst87 + 1.0);
-	fConst89 = (1.0 / ((fConst88 / fConst86) + 1.0));
-	fConst90 = (1.0 - fConst87);
-	fConst91 = (1.0 - (fConst90 / fConst86));
-	fConst92 = mydsp_faustpower2_f(fConst86);
-	fConst93 = (1.0 / fConst92);
-	fConst94 = (2.0 * (1.0 - fConst93));
-	fConst95 = (1.0 / (((fConst15 + 1.0000000000000004) / fConst14) + 1.0));
-	fConst96 = (1.0 / (fConst14 * fConst16));
-	fConst97 = (0.0 - fConst96);
-	fConst98 = (fConst18 / fConst16);
-	fConst99 = (((fConst15 + -1.0000000000000004) / fConst14) + 1.0);
-	fConst100 = (0.0 - (2.0 / fConst20));
-	fConst101 = (1.0 / (((fConst24 + 1.0000000000000004) / fConst23) + 1.0));
-	fConst102 = (1.0 / (fConst23 * fConst25));
-	fConst103 = (1.0 / fConst16);
-	fConst104 = (0.0 - fConst102);
-	fConst105 = (fConst27 / fConst25);
-	fConst106 = (((fConst24 + -1.0000000000000004) / fConst23) + 1.0);
-	fConst107 = (0.0 - (2.0 / fConst29));
-	fConst108 = (1.0 / (((fConst33 + 1.0000000000000004) / fConst32) + 1.0));
-	fConst109 = (1.0 / (fConst32 * fConst34));
-	fConst110 = (1.0 / fConst25);
-	fConst111 = (0.0 - fConst109);
-	fConst112 = (fConst36 / fConst34);
-	fConst113 = (((fConst33 + -1.0000000000000004) / fConst32) + 1.0);
-	fConst114 = (0.0 - (2.0 / fConst38));
-	fConst115 = (1.0 / (((fConst42 + 1.0000000000000004) / fConst41) + 1.0));
-	fConst116 = (1.0 / (fConst41 * fConst43));
-	fConst117 = (1.0 / fConst34);
-	fConst118 = (0.0 - fConst116);
-	fConst119 = (fConst45 / fConst43);
-	fConst120 = (((fConst42 + -1.0000000000000004) / fConst41) + 1.0);
-	fConst121 = (0.0 - (2.0 / fConst47));
-	fConst122 = (1.0 / (((fConst51 + 1.0000000000000004) / fConst50) + 1.0));
-	fConst123 = (1.0 / (fConst50 * fConst52));
-	fConst124 = (1.0 / fConst43);
-	fConst125 = (0.0 - fConst123);
-	fConst126 = (fConst54 / fConst52);
-	fConst127 = (((fConst51 + -1.0000000000000004) / fConst50) + 1.0);
-	fConst128 = (0.0 - (2.0 / fConst56));
-	fConst129 = (1.0 / (((fConst60 + 1.0000000000000004) / fConst59) + 1.0));
-	fConst130 = (1.0 / (fConst59 * fConst61));
-	fConst131 = (1.0 / fConst52);
-	fConst132 = (0.0 - fConst130);
-	fConst133 = (fConst63 / fConst61);
-	fConst134 = (((fConst60 + -1.0000000000000004) / fConst59) + 1.0);
-	fConst135 = (0.0 - (2.0 / fConst65));
-	fConst136 = (1.0 / (((fConst69 + 1.0000000000000004) / fConst68) + 1.0));
-	fConst137 = (1.0 / (fConst68 * fConst70));
-	fConst138 = (1.0 / fConst61);
-	fConst139 = (0.0 - fConst137);
-	fConst140 = (fConst72 / fConst70);
-	fConst141 = (((fConst69 + -1.0000000000000004) / fConst68) + 1.0);
-	fConst142 = (0.0 - (2.0 / fConst74));
-	fConst143 = (1.0 / (((fConst78 + 1.0000000000000004) / fConst77) + 1.0));
-	fConst144 = (1.0 / (fConst77 * fConst79));
-	fConst145 = (1.0 / fConst70);
-	fConst146 = (0.0 - fConst144);
-	fConst147 = (fConst81 / fConst79);
-	fConst148 = (((fConst78 + -1.0000000000000004) / fConst77) + 1.0);
-	fConst149 = (0.0 - (2.0 / fConst83));
-	fConst150 = (1.0 / (((fConst87 + 1.0000000000000004) / fConst86) + 1.0));
-	fConst151 = (1.0 / (fConst86 * fConst88));
-	fConst152 = (1.0 / fConst79);
-	fConst153 = (0.0 - fConst151);
-	fConst154 = (fConst90 / fConst88);
-	fConst155 = (((fConst87 + -1.0000000000000004) / fConst86) + 1.0);
-	fConst156 = (0.0 - (2.0 / fConst92));
-	fConst157 = (1.0 / fConst88);
+	const double fConst0 = std::min<double>(192000.0, std::max<double>(1.0, double(fSamplingFreq)));
+	if (fRef) ref_release(fRef);
+	fRate = bank_rate(fConst0);
+	fRef = ref_acquire(fConst0);
+	fMeterMs = -1;
 	fVslider0 = FAUSTFLOAT(1.0);
 	fVslider1 = FAUSTFLOAT(0.0);
 	fVslider2 = FAUSTFLOAT(0.0);
@@ -728,8 +795,19 @@ inline void Dsp::init(uint32_t samplingFreq)
 	fVslider10 = FAUSTFLOAT(0.0);
 	fVslider11 = FAUSTFLOAT(0.0);
 	fVslider12 = FAUSTFLOAT(0.0);
+	fBank.init(&fRef->bank, fConst0);
+	fRamp.init(fConst0);
+	fFir.init(fConst0);
+	fFit.init(fConst0);
+	// the slowest pole of the lowest split decays with the real part of its
+	// prewarped frequency, which is bank_xover[] times fs. Twice the time
+	// it takes from full scale to SILENCE_LEVEL leaves room for the cascade.
+	fTail = int(2.0 * std::log(1.0 / SILENCE_LEVEL) / bank_xover[BANK_STAGES - 1] * fConst0);
+	fFlatFade = std::max<int>(1, int(FLAT_FADE_MS * 0.001 * fConst0 + 0.5));
 	db_zero = 20.*log10(0.0000003); // -137db
+	fSpec.init(fConst0, db_zero);
     anti_denormal = pow(10,-20);
+	for (int l = 0; l < BANK_BANDS; l++) fPowerLast[l] = -1.0;
 	clear_state_f();
 }
 
@@ -738,8 +816,982 @@ void Dsp::init_static(uint32_t samplingFreq, PluginLV2 *p)
 	static_cast<Dsp*>(p)->init(samplingFreq);
 }
 
-void always_inline Dsp::compute(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0)
+// The readings hold their peak for 4096 samples, so with small buffers
+// most runs see the same value again and can skip the log10().
+inline FAUSTFLOAT Dsp::meter_db(int band, double power)
 {
+	if (power != fPowerLast[band]) {
+		fPowerLast[band] = power;
+		fPowerDb[band] = FAUSTFLOAT(20.*log10(power+anti_denormal));
+	}
+	return fPowerDb[band];
+}
+
+// gain ports to the ramps, pow() only runs for the sliders which moved
+inline void Dsp::set_ramps()
+{
+	fRamp.set(0, *fVslider1_, true);
+	fRamp.set(1, *fVslider3_, true);
+	fRamp.set(2, *fVslider4_, true);
+	fRamp.set(3, *fVslider5_, true);
+	fRamp.set(4, *fVslider6_, true);
+	fRamp.set(5, *fVslider7_, true);
+	fRamp.set(6, *fVslider8_, true);
+	fRamp.set(7, *fVslider9_, true);
+	fRamp.set(8, *fVslider10_, true);
+	fRamp.set(9, *fVslider11_, true);
+	fRamp.set(10, *fVslider12_, true);
+	fRamp.set(RAMP_MORPH, *fVslider0_, false);
+	fRamp.set(RAMP_INGAIN, *fVslider2_, true);
+}
+
+// mode and window of the band meters from the ports, while matching they
+// show the peaks and add up the energy whatever the mode
+inline int Dsp::set_meter(bool matching)
+{
+	int mode = meter_ ? std::min<int>(std::max<int>(int(*meter_), METER_OFF), METER_RMS) : METER_PEAK;
+	if (matching) mode = METER_MATCH;
+	int window = fBank.window();
+	const FAUSTFLOAT ms = meter_ms_ ? *meter_ms_ : FAUSTFLOAT(85.0);
+	if (ms != fMeterMs) {
+		fMeterMs = ms;
+		// at least a chunk, the kernels reset at most once per chunk
+		window = std::max<int>(BANK_CHUNK, int(std::min<double>(ms, 1000.0) * 0.001 * fSamplingFreq + 0.5));
+	}
+	fBank.set_meter(mode, window);
+	return mode;
+}
+
+// A match capture runs while MATCH1 or MATCH2 is on: the meters add up
+// the energy of the bands in fBank, and when the switch goes off the mean
+// level of each band over the capture is left for match_spectrum(). That
+// doesn't depend on how often anybody looks at the meters, and works
+// without a GUI. Silent stretches the kernel skips don't count.
+// With the worker thread fSpec analyses the same input alongside, and the
+// levels wait for its result, see work_response_static().
+inline bool Dsp::capture()
+{
+	const int m = (match2_ && *match2_ > 0.5f) ? 2 : (match1_ && *match1_ > 0.5f) ? 1 : 0;
+	if (m != fMatch) {
+		if (fMatch) {
+			for (int b = 0; b < BANK_BANDS; b++) {
+				const double e = fBank.energy(BANK_BANDS - 1 - b);
+				fMatchDb[b] = (fMatchFrames > 0 && e > 0)
+					? FAUSTFLOAT(std::max<double>(db_zero, 10.*log10(e / fMatchFrames))) : db_zero;
+			}
+			if (fSpec.stop()) {
+				fMatchWait = fMatch;
+			} else {
+				fMatchDone = fMatch;
+				fSpecDone = 0;
+			}
+		}
+		if (m) fSpec.start((resolution_ && *resolution_ > 9.0f) ? 12 : 6);
+		fBank.clear_energy();
+		fMatchFrames = 0;
+		fMatch = m;
+	}
+	return m != 0;
+}
+
+// band meters of the hand written engines
+inline void Dsp::bank_power()
+{
+	_power0 = fBank.power(0);
+	_power1 = fBank.power(1);
+	_power2 = fBank.power(2);
+	_power3 = fBank.power(3);
+	_power4 = fBank.power(4);
+	_power5 = fBank.power(5);
+	_power6 = fBank.power(6);
+	_power7 = fBank.power(7);
+	_power8 = fBank.power(8);
+	_power9 = fBank.power(9);
+	_power10 = fBank.power(10);
+}
+
+// meter ports
+inline void Dsp::report()
+{
+	*fVbargraph0_ = (*bypass_? meter_db(0, _power0) : db_zero);
+	*fVbargraph1_ = (*bypass_? meter_db(1, _power1) : db_zero);
+	*fVbargraph2_ = (*bypass_? meter_db(2, _power2) : db_zero);
+	*fVbargraph3_ = (*bypass_? meter_db(3, _power3) : db_zero);
+	*fVbargraph4_ = (*bypass_? meter_db(4, _power4) : db_zero);
+	*fVbargraph5_ = (*bypass_? meter_db(5, _power5) : db_zero);
+	*fVbargraph6_ = (*bypass_? meter_db(6, _power6) : db_zero);
+	*fVbargraph7_ = (*bypass_? meter_db(7, _power7) : db_zero);
+	*fVbargraph8_ = (*bypass_? meter_db(8, _power8) : db_zero);
+	*fVbargraph9_ = (*bypass_? meter_db(9, _power9) : db_zero);
+	*fVbargraph10_ = (*bypass_? meter_db(10, _power10) : db_zero);
+}
+
+// meter ports while the kernel is stopped
+inline void Dsp::report_idle()
+{
+	*fVbargraph0_ = db_zero;
+	*fVbargraph1_ = db_zero;
+	*fVbargraph2_ = db_zero;
+	*fVbargraph3_ = db_zero;
+	*fVbargraph4_ = db_zero;
+	*fVbargraph5_ = db_zero;
+	*fVbargraph6_ = db_zero;
+	*fVbargraph7_ = db_zero;
+	*fVbargraph8_ = db_zero;
+	*fVbargraph9_ = db_zero;
+	*fVbargraph10_ = db_zero;
+}
+
+inline int Dsp::latency() const
+{
+	return (fEngine == 3) ? fFir.latency() : (fEngine == 5) ? fBank.latency() : 0;
+}
+
+// Silence detection. Once the input stayed under SILENCE_LEVEL for the
+// tail of the lowest split plus the latency, and the output followed it
+// down, settle() stops the kernel. From then on the output is zero and
+// the meters at db_zero until the input comes back. What is left in the
+// filter state is under SILENCE_LEVEL and just carries on then.
+inline bool Dsp::idle(int count, int channels, FAUSTFLOAT **inputs, FAUSTFLOAT **outputs)
+{
+	if (skipped_) *skipped_ = FAUSTFLOAT(fSkipped & 0xffffff);
+	float peak = 0.0f;
+	for (int c = 0; c < channels; c++) {
+		const FAUSTFLOAT *in = inputs[c];
+		for (int i = 0; i < count; i++) peak = std::max<float>(peak, std::fabs(in[i]));
+	}
+	if (peak > SILENCE_LEVEL) {
+		fSilent = 0;
+		fIdle = false;
+		return false;
+	}
+	fSilent = std::min<int>(fSilent + count, 1 << 30);
+	if (!fIdle) return false;
+	for (int c = 0; c < channels; c++) memset(outputs[c], 0, count * sizeof(FAUSTFLOAT));
+	report_idle();
+	fSkipped++;
+	return true;
+}
+
+inline void Dsp::settle(int count, int channels, FAUSTFLOAT **outputs, int delay)
+{
+	if (fSilent < fTail + delay) return;
+	float peak = 0.0f;
+	for (int c = 0; c < channels; c++) {
+		const FAUSTFLOAT *out = outputs[c];
+		for (int i = 0; i < count; i++) peak = std::max<float>(peak, std::fabs(out[i]));
+	}
+	if (peak > SILENCE_LEVEL) return;
+	fIdle = true;
+	// the meters start from the floor when the input comes back
+	fBank.clear_power();
+}
+
+// engine 1 and 2
+inline void Dsp::run_bank(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0,
+                          const BankParam& p, bool block)
+{
+	if (fEngine == 2)
+		fBank.compute_tree(count, input0, output0, p);
+	else if (block)
+		fBank.compute_block(count, input0, output0, p);
+	else
+		fBank.compute(count, input0, output0, p);
+}
+
+// Fast path of engine 1 and 2 at equal band gains and with the band
+// meters off, the cascade of the split allpasses in
+// SimdBank::compute_flat(), or pass-through with the FLAT port at 2.
+// count is at most FIR_PART.
+//
+// On the way in, the flat path runs along with the bank from a cleared
+// state. Its start-up decays like the tail of the lowest split, so after
+// fTail samples both agree to about SILENCE_LEVEL and it takes over
+// without a fade. Pass-through fades in over fFlatFade instead.
+// On the way out, the bank starts again from a cleared state, with the
+// gains already ramping, and fades in over fFlatFade on a cubic curve.
+// That keeps its start-up (time constant 1 / bank_xover[9]) about 50 dB
+// below the level of the lowest band.
+inline void Dsp::run_flat(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0,
+                          const BankParam& p, bool block, bool ok)
+{
+	const bool through = flat_ && int(*flat_) == 2;
+	const bool flat = ok && bank_flat(p) && (fFlat == FLAT_OFF || through == fFlatThrough);
+	if (fFlat == FLAT_OFF) {
+		fFlat = FLAT_ENTER;
+		fFlatThrough = through;
+		fFlatLeft = through ? fFlatFade : fTail;
+		fBank.clear_flat();
+	} else if (fFlat == FLAT_ENTER && !flat) {
+		fFlat = FLAT_OFF; // the bank never stopped
+	} else if (fFlat == FLAT_ON && !flat) {
+		fFlat = FLAT_LEAVE;
+		fFlatLeft = fFlatFade;
+		fBank.clear_sections();
+	}
+	FAUSTFLOAT fWet[FIR_PART];
+	switch (fFlat) {
+	case FLAT_OFF:
+		run_bank(count, input0, output0, p, block);
+		break;
+	case FLAT_ON:
+		fBank.compute_flat(count, input0, output0, p, fFlatThrough);
+		// where the parameters end up, held for the way out
+		fFlatParam = p;
+		fFlatParam.gain[0] += count * p.gstep[0];
+		fFlatParam.gstep[0] = 0.0;
+		fFlatParam.morph += count * p.mstep;
+		fFlatParam.mstep = 0.0;
+		fFlatParam.ingain += count * p.istep;
+		fFlatParam.istep = 0.0;
+		break;
+	case FLAT_ENTER: {
+		run_bank(count, input0, fWet, p, block);
+		fBank.compute_flat(count, input0, output0, p, fFlatThrough);
+		const double step = fFlatThrough ? 1.0 / fFlatFade : 0.0;
+		const double w0 = (fFlatFade - fFlatLeft) * step;
+		for (int i = 0; i < count; i++) {
+			const double w = std::min<double>(1.0, w0 + (i + 1) * step);
+			output0[i] = FAUSTFLOAT(w * output0[i] + (1.0 - w) * fWet[i]);
+		}
+		fFlatLeft -= count;
+		if (fFlatLeft <= 0) {
+			fFlat = FLAT_ON;
+			fFlatParam = p;
+		}
+		break;
+	}
+	case FLAT_LEAVE: {
+		run_bank(count, input0, fWet, p, block);
+		fBank.compute_flat(count, input0, output0, fFlatParam, fFlatThrough);
+		const double step = 1.0 / fFlatFade;
+		const double w0 = (fFlatFade - fFlatLeft) * step;
+		for (int i = 0; i < count; i++) {
+			const double v = std::min<double>(1.0, w0 + (i + 1) * step);
+			const double w = v * v * v;
+			output0[i] = FAUSTFLOAT(w * fWet[i] + (1.0 - w) * output0[i]);
+		}
+		fFlatLeft -= count;
+		if (fFlatLeft <= 0) fFlat = FLAT_OFF;
+		break;
+	}
+	}
+}
+
+// one sample of a band meter of engine 0, the detector of the generated
+// code with the window and mode of fBank
+template <int M>
+always_inline void Dsp::ref_meter(int band, double y, double& env, int& count, double& hold, double floor)
+{
+	if (M == METER_OFF) return;
+	if (M == METER_MATCH) fBank.add_energy(band, y * y);
+	const bool run = count < fBank.window();
+	const double a = (M == METER_RMS) ? y * y : std::max<double>(floor, std::fabs(y));
+	hold = run ? hold : meter_read<M>(env, 1.0 / fBank.window(), floor);
+	env = run ? ((M == METER_RMS) ? env + a : std::max<double>(env, a)) : a;
+	count = run ? count + 1 : 1;
+}
+
+// the faust kernel of engine 0, R >= 0 runs on the constants of
+// bank_rates[R] known at compile time, M is the meter mode
+template <int R, int M>
+inline void Dsp::compute_ref(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0)
+{
+#define fConst (R < 0 ? fRef->ref.c : ref_table[R].c)
+	double fSlow0 = (0.0010000000000000009 * double(*fVslider0_));
+	double fSlow1 = (0.0010000000000000009 * fRamp.target(0));
+	double fSlow2 = (0.0010000000000000009 * fRamp.target(RAMP_INGAIN));
+	double fSlow3 = (0.0010000000000000009 * fRamp.target(1));
+	double fSlow4 = (0.0010000000000000009 * fRamp.target(2));
+	double fSlow5 = (0.0010000000000000009 * fRamp.target(3));
+	double fSlow6 = (0.0010000000000000009 * fRamp.target(4));
+	double fSlow7 = (0.0010000000000000009 * fRamp.target(5));
+	double fSlow8 = (0.0010000000000000009 * fRamp.target(6));
+	double fSlow9 = (0.0010000000000000009 * fRamp.target(7));
+	double fSlow10 = (0.0010000000000000009 * fRamp.target(8));
+	double fSlow11 = (0.0010000000000000009 * fRamp.target(9));
+	double fSlow12 = (0.0010000000000000009 * fRamp.target(10));
+	// the state of the filters lives in locals across the loop, the
+	// shifts at its end are renames
+	double fRec0_1 = fRec0[1];
+	double fRec4_1 = fRec4[1];
+	double fRec16_1 = fRec16[1];
+	double fVec0_1 = fVec0[1];
+	double fRec15_1 = fRec15[1];
+	double fRec14_1 = fRec14[1], fRec14_2 = fRec14[2];
+	double fRec13_1 = fRec13[1], fRec13_2 = fRec13[2];
+	double fRec12_1 = fRec12[1], fRec12_2 = fRec12[2];
+	double fRec11_1 = fRec11[1], fRec11_2 = fRec11[2];
+	double fRec10_1 = fRec10[1], fRec10_2 = fRec10[2];
+	double fRec9_1 = fRec9[1], fRec9_2 = fRec9[2];
+	double fRec8_1 = fRec8[1], fRec8_2 = fRec8[2];
+	double fRec7_1 = fRec7[1], fRec7_2 = fRec7[2];
+	double fRec6_1 = fRec6[1], fRec6_2 = fRec6[2];
+	double fRec5_1 = fRec5[1], fRec5_2 = fRec5[2];
+	double fRec1_1 = fRec1[1];
+	int iRec2_1 = iRec2[1];
+	double fRec3_1 = fRec3[1];
+	double fRec20_1 = fRec20[1];
+	double fRec32_1 = fRec32[1];
+	double fRec31_1 = fRec31[1], fRec31_2 = fRec31[2];
+	double fVec1_1 = fVec1[1];
+	double fRec30_1 = fRec30[1];
+	double fRec29_1 = fRec29[1], fRec29_2 = fRec29[2];
+	double fRec28_1 = fRec28[1], fRec28_2 = fRec28[2];
+	double fRec27_1 = fRec27[1], fRec27_2 = fRec27[2];
+	double fRec26_1 = fRec26[1], fRec26_2 = fRec26[2];
+	double fRec25_1 = fRec25[1], fRec25_2 = fRec25[2];
+	double fRec24_1 = fRec24[1], fRec24_2 = fRec24[2];
+	double fRec23_1 = fRec23[1], fRec23_2 = fRec23[2];
+	double fRec22_1 = fRec22[1], fRec22_2 = fRec22[2];
+	double fRec21_1 = fRec21[1], fRec21_2 = fRec21[2];
+	double fRec17_1 = fRec17[1];
+	int iRec18_1 = iRec18[1];
+	double fRec19_1 = fRec19[1];
+	double fRec36_1 = fRec36[1];
+	double fRec47_1 = fRec47[1];
+	double fRec46_1 = fRec46[1], fRec46_2 = fRec46[2];
+	double fVec2_1 = fVec2[1];
+	double fRec45_1 = fRec45[1];
+	double fRec44_1 = fRec44[1], fRec44_2 = fRec44[2];
+	double fRec43_1 = fRec43[1], fRec43_2 = fRec43[2];
+	double fRec42_1 = fRec42[1], fRec42_2 = fRec42[2];
+	double fRec41_1 = fRec41[1], fRec41_2 = fRec41[2];
+	double fRec40_1 = fRec40[1], fRec40_2 = fRec40[2];
+	double fRec39_1 = fRec39[1], fRec39_2 = fRec39[2];
+	double fRec38_1 = fRec38[1], fRec38_2 = fRec38[2];
+	double fRec37_1 = fRec37[1], fRec37_2 = fRec37[2];
+	double fRec33_1 = fRec33[1];
+	int iRec34_1 = iRec34[1];
+	double fRec35_1 = fRec35[1];
+	double fRec51_1 = fRec51[1];
+	double fRec61_1 = fRec61[1];
+	double fRec60_1 = fRec60[1], fRec60_2 = fRec60[2];
+	double fVec3_1 = fVec3[1];
+	double fRec59_1 = fRec59[1];
+	double fRec58_1 = fRec58[1], fRec58_2 = fRec58[2];
+	double fRec57_1 = fRec57[1], fRec57_2 = fRec57[2];
+	double fRec56_1 = fRec56[1], fRec56_2 = fRec56[2];
+	double fRec55_1 = fRec55[1], fRec55_2 = fRec55[2];
+	double fRec54_1 = fRec54[1], fRec54_2 = fRec54[2];
+	double fRec53_1 = fRec53[1], fRec53_2 = fRec53[2];
+	double fRec52_1 = fRec52[1], fRec52_2 = fRec52[2];
+	double fRec48_1 = fRec48[1];
+	int iRec49_1 = iRec49[1];
+	double fRec50_1 = fRec50[1];
+	double fRec65_1 = fRec65[1];
+	double fRec74_1 = fRec74[1];
+	double fRec73_1 = fRec73[1], fRec73_2 = fRec73[2];
+	double fVec4_1 = fVec4[1];
+	double fRec72_1 = fRec72[1];
+	double fRec71_1 = fRec71[1], fRec71_2 = fRec71[2];
+	double fRec70_1 = fRec70[1], fRec70_2 = fRec70[2];
+	double fRec69_1 = fRec69[1], fRec69_2 = fRec69[2];
+	double fRec68_1 = fRec68[1], fRec68_2 = fRec68[2];
+	double fRec67_1 = fRec67[1], fRec67_2 = fRec67[2];
+	double fRec66_1 = fRec66[1], fRec66_2 = fRec66[2];
+	double fRec62_1 = fRec62[1];
+	int iRec63_1 = iRec63[1];
+	double fRec64_1 = fRec64[1];
+	double fRec78_1 = fRec78[1];
+	double fRec86_1 = fRec86[1];
+	double fRec85_1 = fRec85[1], fRec85_2 = fRec85[2];
+	double fVec5_1 = fVec5[1];
+	double fRec84_1 = fRec84[1];
+	double fRec83_1 = fRec83[1], fRec83_2 = fRec83[2];
+	double fRec82_1 = fRec82[1], fRec82_2 = fRec82[2];
+	double fRec81_1 = fRec81[1], fRec81_2 = fRec81[2];
+	double fRec80_1 = fRec80[1], fRec80_2 = fRec80[2];
+	double fRec79_1 = fRec79[1], fRec79_2 = fRec79[2];
+	double fRec75_1 = fRec75[1];
+	int iRec76_1 = iRec76[1];
+	double fRec77_1 = fRec77[1];
+	double fRec90_1 = fRec90[1];
+	double fRec97_1 = fRec97[1];
+	double fRec96_1 = fRec96[1], fRec96_2 = fRec96[2];
+	double fVec6_1 = fVec6[1];
+	double fRec95_1 = fRec95[1];
+	double fRec94_1 = fRec94[1], fRec94_2 = fRec94[2];
+	double fRec93_1 = fRec93[1], fRec93_2 = fRec93[2];
+	double fRec92_1 = fRec92[1], fRec92_2 = fRec92[2];
+	double fRec91_1 = fRec91[1], fRec91_2 = fRec91[2];
+	double fRec87_1 = fRec87[1];
+	int iRec88_1 = iRec88[1];
+	double fRec89_1 = fRec89[1];
+	double fRec101_1 = fRec101[1];
+	double fRec107_1 = fRec107[1];
+	double fRec106_1 = fRec106[1], fRec106_2 = fRec106[2];
+	double fVec7_1 = fVec7[1];
+	double fRec105_1 = fRec105[1];
+	double fRec104_1 = fRec104[1], fRec104_2 = fRec104[2];
+	double fRec103_1 = fRec103[1], fRec103_2 = fRec103[2];
+	double fRec102_1 = fRec102[1], fRec102_2 = fRec102[2];
+	double fRec98_1 = fRec98[1];
+	int iRec99_1 = iRec99[1];
+	double fRec100_1 = fRec100[1];
+	double fRec111_1 = fRec111[1];
+	double fRec116_1 = fRec116[1];
+	double fRec115_1 = fRec115[1], fRec115_2 = fRec115[2];
+	double fVec8_1 = fVec8[1];
+	double fRec114_1 = fRec114[1];
+	double fRec113_1 = fRec113[1], fRec113_2 = fRec113[2];
+	double fRec112_1 = fRec112[1], fRec112_2 = fRec112[2];
+	double fRec108_1 = fRec108[1];
+	int iRec109_1 = iRec109[1];
+	double fRec110_1 = fRec110[1];
+	double fRec120_1 = fRec120[1];
+	double fRec124_1 = fRec124[1];
+	double fRec123_1 = fRec123[1], fRec123_2 = fRec123[2];
+	double fVec9_1 = fVec9[1];
+	double fRec122_1 = fRec122[1];
+	double fRec121_1 = fRec121[1], fRec121_2 = fRec121[2];
+	double fRec117_1 = fRec117[1];
+	int iRec118_1 = iRec118[1];
+	double fRec119_1 = fRec119[1];
+	double fRec128_1 = fRec128[1];
+	double fRec130_1 = fRec130[1];
+	double fRec129_1 = fRec129[1], fRec129_2 = fRec129[2];
+	double fRec125_1 = fRec125[1];
+	int iRec126_1 = iRec126[1];
+	double fRec127_1 = fRec127[1];
+	for (int i = 0; (i < count); i = (i + 1)) {
+		double fRec0_0 = (fSlow0 + (0.999 * fRec0_1));
+		double fTemp0 = double(input0[i]);
+		double fRec4_0 = (fSlow1 + (0.999 * fRec4_1));
+		double fRec16_0 = (fSlow2 + (0.999 * fRec16_1));
+		double fTemp2 = (fRec16_0 * fTemp0);
+		double fVec0_0 = fTemp2;
+		double fRec15_0 = ((fConst[8] * fVec0_1) - (fConst[9] * ((fConst[10] * fRec15_1) - (fConst[3] * fTemp2))));
+		double fRec14_0 = (fRec15_0 - (fConst[4] * ((fConst[11] * fRec14_2) + (fConst[12] * fRec14_1))));
+		double fTemp3 = (fConst[22] * fRec13_1);
+		double fRec13_0 = ((fConst[4] * (((fConst[6] * fRec14_0) + (fConst[13] * fRec14_1)) + (fConst[6] * fRec14_2))) - (fConst[17] * ((fConst[19] * fRec13_2) + fTemp3)));
+		double fTemp4 = (fConst[31] * fRec12_1);
+		double fRec12_0 = ((fRec13_2 + (fConst[17] * (fTemp3 + (fConst[19] * fRec13_0)))) - (fConst[26] * ((fConst[28] * fRec12_2) + fTemp4)));
+		double fTemp5 = (fConst[40] * fRec11_1);
+		double fRec11_0 = ((fRec12_2 + (fConst[26] * (fTemp4 + (fConst[28] * fRec12_0)))) - (fConst[35] * ((fConst[37] * fRec11_2) + fTemp5)));
+		double fTemp6 = (fConst[49] * fRec10_1);
+		double fRec10_0 = ((fRec11_2 + (fConst[35] * (fTemp5 + (fConst[37] * fRec11_0)))) - (fConst[44] * ((fConst[46] * fRec10_2) + fTemp6)));
+		double fTemp7 = (fConst[58] * fRec9_1);
+		double fRec9_0 = ((fRec10_2 + (fConst[44] * (fTemp6 + (fConst[46] * fRec10_0)))) - (fConst[53] * ((fConst[55] * fRec9_2) + fTemp7)));
+		double fTemp8 = (fConst[67] * fRec8_1);
+		double fRec8_0 = ((fRec9_2 + (fConst[53] * (fTemp7 + (fConst[55] * fRec9_0)))) - (fConst[62] * ((fConst[64] * fRec8_2) + fTemp8)));
+		double fTemp9 = (fConst[76] * fRec7_1);
+		double fRec7_0 = ((fRec8_2 + (fConst[62] * (fTemp8 + (fConst[64] * fRec8_0)))) - (fConst[71] * ((fConst[73] * fRec7_2) + fTemp9)));
+		double fTemp10 = (fConst[85] * fRec6_1);
+		double fRec6_0 = ((fRec7_2 + (fConst[71] * (fTemp9 + (fConst[73] * fRec7_0)))) - (fConst[80] * ((fConst[82] * fRec6_2) + fTemp10)));
+		double fTemp11 = (fConst[94] * fRec5_1);
+		double fRec5_0 = ((fRec6_2 + (fConst[80] * (fTemp10 + (fConst[82] * fRec6_0)))) - (fConst[89] * ((fConst[91] * fRec5_2) + fTemp11)));
+		double fTemp12 = (fRec4_0 * (fRec5_2 + (fConst[89] * (fTemp11 + (fConst[91] * fRec5_0)))));
+		ref_meter<M>(0, fTemp12, fRec1_1, iRec2_1, fRec3_1, fConst[1]);
+		double fRec20_0 = (fSlow3 + (0.999 * fRec20_1));
+		double fRec32_0 = (0.0 - (fConst[9] * ((fConst[10] * fRec32_1) - (fTemp2 + fVec0_1))));
+		double fRec31_0 = (fRec32_0 - (fConst[4] * ((fConst[11] * fRec31_2) + (fConst[12] * fRec31_1))));
+		double fTemp15 = (fRec31_2 + (fRec31_0 + (2.0 * fRec31_1)));
+		double fVec1_0 = fTemp15;
+		double fRec30_0 = ((fConst[4] * ((fConst[96] * fTemp15) + (fConst[97] * fVec1_1))) - (fConst[98] * fRec30_1));
+		double fRec29_0 = (fRec30_0 - (fConst[95] * ((fConst[99] * fRec29_2) + (fConst[22] * fRec29_1))));
+		double fTemp16 = (fConst[31] * fRec28_1);
+		double fRec28_0 = ((fConst[95] * (((fConst[21] * fRec29_0) + (fConst[100] * fRec29_1)) + (fConst[21] * fRec29_2))) - (fConst[26] * ((fConst[28] * fRec28_2) + fTemp16)));
+		double fTemp17 = (fConst[40] * fRec27_1);
+		double fRec27_0 = ((fRec28_2 + (fConst[26] * (fTemp16 + (fConst[28] * fRec28_0)))) - (fConst[35] * ((fConst[37] * fRec27_2) + fTemp17)));
+		double fTemp18 = (fConst[49] * fRec26_1);
+		double fRec26_0 = ((fRec27_2 + (fConst[35] * (fTemp17 + (fConst[37] * fRec27_0)))) - (fConst[44] * ((fConst[46] * fRec26_2) + fTemp18)));
+		double fTemp19 = (fConst[58] * fRec25_1);
+		double fRec25_0 = ((fRec26_2 + (fConst[44] * (fTemp18 + (fConst[46] * fRec26_0)))) - (fConst[53] * ((fConst[55] * fRec25_2) + fTemp19)));
+		double fTemp20 = (fConst[67] * fRec24_1);
+		double fRec24_0 = ((fRec25_2 + (fConst[53] * (fTemp19 + (fConst[55] * fRec25_0)))) - (fConst[62] * ((fConst[64] * fRec24_2) + fTemp20)));
+		double fTemp21 = (fConst[76] * fRec23_1);
+		double fRec23_0 = ((fRec24_2 + (fConst[62] * (fTemp20 + (fConst[64] * fRec24_0)))) - (fConst[71] * ((fConst[73] * fRec23_2) + fTemp21)));
+		double fTemp22 = (fConst[85] * fRec22_1);
+		double fRec22_0 = ((fRec23_2 + (fConst[71] * (fTemp21 + (fConst[73] * fRec23_0)))) - (fConst[80] * ((fConst[82] * fRec22_2) + fTemp22)));
+		double fTemp23 = (fConst[94] * fRec21_1);
+		double fRec21_0 = ((fRec22_2 + (fConst[80] * (fTemp22 + (fConst[82] * fRec22_0)))) - (fConst[89] * ((fConst[91] * fRec21_2) + fTemp23)));
+		double fTemp24 = (fRec20_0 * (fRec21_2 + (fConst[89] * (fTemp23 + (fConst[91] * fRec21_0)))));
+		ref_meter<M>(1, fTemp24, fRec17_1, iRec18_1, fRec19_1, fConst[1]);
+		double fRec36_0 = (fSlow4 + (0.999 * fRec36_1));
+		double fRec47_0 = (0.0 - (fConst[103] * ((fConst[18] * fRec47_1) - (fConst[4] * (fTemp15 + fVec1_1)))));
+		double fRec46_0 = (fRec47_0 - (fConst[95] * ((fConst[99] * fRec46_2) + (fConst[22] * fRec46_1))));
+		double fTemp27 = (fRec46_2 + (fRec46_0 + (2.0 * fRec46_1)));
+		double fVec2_0 = fTemp27;
+		double fRec45_0 = ((fConst[95] * ((fConst[102] * fTemp27) + (fConst[104] * fVec2_1))) - (fConst[105] * fRec45_1));
+		double fRec44_0 = (fRec45_0 - (fConst[101] * ((fConst[106] * fRec44_2) + (fConst[31] * fRec44_1))));
+		double fTemp28 = (fConst[40] * fRec43_1);
+		double fRec43_0 = ((fConst[101] * (((fConst[30] * fRec44_0) + (fConst[107] * fRec44_1)) + (fConst[30] * fRec44_2))) - (fConst[35] * ((fConst[37] * fRec43_2) + fTemp28)));
+		double fTemp29 = (fConst[49] * fRec42_1);
+		double fRec42_0 = ((fRec43_2 + (fConst[35] * (fTemp28 + (fConst[37] * fRec43_0)))) - (fConst[44] * ((fConst[46] * fRec42_2) + fTemp29)));
+		double fTemp30 = (fConst[58] * fRec41_1);
+		double fRec41_0 = ((fRec42_2 + (fConst[44] * (fTemp29 + (fConst[46] * fRec42_0)))) - (fConst[53] * ((fConst[55] * fRec41_2) + fTemp30)));
+		double fTemp31 = (fConst[67] * fRec40_1);
+		double fRec40_0 = ((fRec41_2 + (fConst[53] * (fTemp30 + (fConst[55] * fRec41_0)))) - (fConst[62] * ((fConst[64] * fRec40_2) + fTemp31)));
+		double fTemp32 = (fConst[76] * fRec39_1);
+		double fRec39_0 = ((fRec40_2 + (fConst[62] * (fTemp31 + (fConst[64] * fRec40_0)))) - (fConst[71] * ((fConst[73] * fRec39_2) + fTemp32)));
+		double fTemp33 = (fConst[85] * fRec38_1);
+		double fRec38_0 = ((fRec39_2 + (fConst[71] * (fTemp32 + (fConst[73] * fRec39_0)))) - (fConst[80] * ((fConst[82] * fRec38_2) + fTemp33)));
+		double fTemp34 = (fConst[94] * fRec37_1);
+		double fRec37_0 = ((fRec38_2 + (fConst[80] * (fTemp33 + (fConst[82] * fRec38_0)))) - (fConst[89] * ((fConst[91] * fRec37_2) + fTemp34)));
+		double fTemp35 = (fRec36_0 * (fRec37_2 + (fConst[89] * (fTemp34 + (fConst[91] * fRec37_0)))));
+		ref_meter<M>(2, fTemp35, fRec33_1, iRec34_1, fRec35_1, fConst[1]);
+		double fRec51_0 = (fSlow5 + (0.999 * fRec51_1));
+		double fRec61_0 = (0.0 - (fConst[110] * ((fConst[27] * fRec61_1) - (fConst[95] * (fTemp27 + fVec2_1)))));
+		double fRec60_0 = (fRec61_0 - (fConst[101] * ((fConst[106] * fRec60_2) + (fConst[31] * fRec60_1))));
+		double fTemp38 = (fRec60_2 + (fRec60_0 + (2.0 * fRec60_1)));
+		double fVec3_0 = fTemp38;
+		double fRec59_0 = ((fConst[101] * ((fConst[109] * fTemp38) + (fConst[111] * fVec3_1))) - (fConst[112] * fRec59_1));
+		double fRec58_0 = (fRec59_0 - (fConst[108] * ((fConst[113] * fRec58_2) + (fConst[40] * fRec58_1))));
+		double fTemp39 = (fConst[49] * fRec57_1);
+		double fRec57_0 = ((fConst[108] * (((fConst[39] * fRec58_0) + (fConst[114] * fRec58_1)) + (fConst[39] * fRec58_2))) - (fConst[44] * ((fConst[46] * fRec57_2) + fTemp39)));
+		double fTemp40 = (fConst[58] * fRec56_1);
+		double fRec56_0 = ((fRec57_2 + (fConst[44] * (fTemp39 + (fConst[46] * fRec57_0)))) - (fConst[53] * ((fConst[55] * fRec56_2) + fTemp40)));
+		double fTemp41 = (fConst[67] * fRec55_1);
+		double fRec55_0 = ((fRec56_2 + (fConst[53] * (fTemp40 + (fConst[55] * fRec56_0)))) - (fConst[62] * ((fConst[64] * fRec55_2) + fTemp41)));
+		double fTemp42 = (fConst[76] * fRec54_1);
+		double fRec54_0 = ((fRec55_2 + (fConst[62] * (fTemp41 + (fConst[64] * fRec55_0)))) - (fConst[71] * ((fConst[73] * fRec54_2) + fTemp42)));
+		double fTemp43 = (fConst[85] * fRec53_1);
+		double fRec53_0 = ((fRec54_2 + (fConst[71] * (fTemp42 + (fConst[73] * fRec54_0)))) - (fConst[80] * ((fConst[82] * fRec53_2) + fTemp43)));
+		double fTemp44 = (fConst[94] * fRec52_1);
+		double fRec52_0 = ((fRec53_2 + (fConst[80] * (fTemp43 + (fConst[82] * fRec53_0)))) - (fConst[89] * ((fConst[91] * fRec52_2) + fTemp44)));
+		double fTemp45 = (fRec51_0 * (fRec52_2 + (fConst[89] * (fTemp44 + (fConst[91] * fRec52_0)))));
+		ref_meter<M>(3, fTemp45, fRec48_1, iRec49_1, fRec50_1, fConst[1]);
+		double fRec65_0 = (fSlow6 + (0.999 * fRec65_1));
+		double fRec74_0 = (0.0 - (fConst[117] * ((fConst[36] * fRec74_1) - (fConst[101] * (fTemp38 + fVec3_1)))));
+		double fRec73_0 = (fRec74_0 - (fConst[108] * ((fConst[113] * fRec73_2) + (fConst[40] * fRec73_1))));
+		double fTemp48 = (fRec73_2 + (fRec73_0 + (2.0 * fRec73_1)));
+		double fVec4_0 = fTemp48;
+		double fRec72_0 = ((fConst[108] * ((fConst[116] * fTemp48) + (fConst[118] * fVec4_1))) - (fConst[119] * fRec72_1));
+		double fRec71_0 = (fRec72_0 - (fConst[115] * ((fConst[120] * fRec71_2) + (fConst[49] * fRec71_1))));
+		double fTemp49 = (fConst[58] * fRec70_1);
+		double fRec70_0 = ((fConst[115] * (((fConst[48] * fRec71_0) + (fConst[121] * fRec71_1)) + (fConst[48] * fRec71_2))) - (fConst[53] * ((fConst[55] * fRec70_2) + fTemp49)));
+		double fTemp50 = (fConst[67] * fRec69_1);
+		double fRec69_0 = ((fRec70_2 + (fConst[53] * (fTemp49 + (fConst[55] * fRec70_0)))) - (fConst[62] * ((fConst[64] * fRec69_2) + fTemp50)));
+		double fTemp51 = (fConst[76] * fRec68_1);
+		double fRec68_0 = ((fRec69_2 + (fConst[62] * (fTemp50 + (fConst[64] * fRec69_0)))) - (fConst[71] * ((fConst[73] * fRec68_2) + fTemp51)));
+		double fTemp52 = (fConst[85] * fRec67_1);
+		double fRec67_0 = ((fRec68_2 + (fConst[71] * (fTemp51 + (fConst[73] * fRec68_0)))) - (fConst[80] * ((fConst[82] * fRec67_2) + fTemp52)));
+		double fTemp53 = (fConst[94] * fRec66_1);
+		double fRec66_0 = ((fRec67_2 + (fConst[80] * (fTemp52 + (fConst[82] * fRec67_0)))) - (fConst[89] * ((fConst[91] * fRec66_2) + fTemp53)));
+		double fTemp54 = (fRec65_0 * (fRec66_2 + (fConst[89] * (fTemp53 + (fConst[91] * fRec66_0)))));
+		ref_meter<M>(4, fTemp54, fRec62_1, iRec63_1, fRec64_1, fConst[1]);
+		double fRec78_0 = (fSlow7 + (0.999 * fRec78_1));
+		double fRec86_0 = (0.0 - (fConst[124] * ((fConst[45] * fRec86_1) - (fConst[108] * (fTemp48 + fVec4_1)))));
+		double fRec85_0 = (fRec86_0 - (fConst[115] * ((fConst[120] * fRec85_2) + (fConst[49] * fRec85_1))));
+		double fTemp57 = (fRec85_2 + (fRec85_0 + (2.0 * fRec85_1)));
+		double fVec5_0 = fTemp57;
+		double fRec84_0 = ((fConst[115] * ((fConst[123] * fTemp57) + (fConst[125] * fVec5_1))) - (fConst[126] * fRec84_1));
+		double fRec83_0 = (fRec84_0 - (fConst[122] * ((fConst[127] * fRec83_2) + (fConst[58] * fRec83_1))));
+		double fTemp58 = (fConst[67] * fRec82_1);
+		double fRec82_0 = ((fConst[122] * (((fConst[57] * fRec83_0) + (fConst[128] * fRec83_1)) + (fConst[57] * fRec83_2))) - (fConst[62] * ((fConst[64] * fRec82_2) + fTemp58)));
+		double fTemp59 = (fConst[76] * fRec81_1);
+		double fRec81_0 = ((fRec82_2 + (fConst[62] * (fTemp58 + (fConst[64] * fRec82_0)))) - (fConst[71] * ((fConst[73] * fRec81_2) + fTemp59)));
+		double fTemp60 = (fConst[85] * fRec80_1);
+		double fRec80_0 = ((fRec81_2 + (fConst[71] * (fTemp59 + (fConst[73] * fRec81_0)))) - (fConst[80] * ((fConst[82] * fRec80_2) + fTemp60)));
+		double fTemp61 = (fConst[94] * fRec79_1);
+		double fRec79_0 = ((fRec80_2 + (fConst[80] * (fTemp60 + (fConst[82] * fRec80_0)))) - (fConst[89] * ((fConst[91] * fRec79_2) + fTemp61)));
+		double fTemp62 = (fRec78_0 * (fRec79_2 + (fConst[89] * (fTemp61 + (fConst[91] * fRec79_0)))));
+		ref_meter<M>(5, fTemp62, fRec75_1, iRec76_1, fRec77_1, fConst[1]);
+		double fRec90_0 = (fSlow8 + (0.999 * fRec90_1));
+		double fRec97_0 = (0.0 - (fConst[131] * ((fConst[54] * fRec97_1) - (fConst[115] * (fTemp57 + fVec5_1)))));
+		double fRec96_0 = (fRec97_0 - (fConst[122] * ((fConst[127] * fRec96_2) + (fConst[58] * fRec96_1))));
+		double fTemp65 = (fRec96_2 + (fRec96_0 + (2.0 * fRec96_1)));
+		double fVec6_0 = fTemp65;
+		double fRec95_0 = ((fConst[122] * ((fConst[130] * fTemp65) + (fConst[132] * fVec6_1))) - (fConst[133] * fRec95_1));
+		double fRec94_0 = (fRec95_0 - (fConst[129] * ((fConst[134] * fRec94_2) + (fConst[67] * fRec94_1))));
+		double fTemp66 = (fConst[76] * fRec93_1);
+		double fRec93_0 = ((fConst[129] * (((fConst[66] * fRec94_0) + (fConst[135] * fRec94_1)) + (fConst[66] * fRec94_2))) - (fConst[71] * ((fConst[73] * fRec93_2) + fTemp66)));
+		double fTemp67 = (fConst[85] * fRec92_1);
+		double fRec92_0 = ((fRec93_2 + (fConst[71] * (fTemp66 + (fConst[73] * fRec93_0)))) - (fConst[80] * ((fConst[82] * fRec92_2) + fTemp67)));
+		double fTemp68 = (fConst[94] * fRec91_1);
+		double fRec91_0 = ((fRec92_2 + (fConst[80] * (fTemp67 + (fConst[82] * fRec92_0)))) - (fConst[89] * ((fConst[91] * fRec91_2) + fTemp68)));
+		double fTemp69 = (fRec90_0 * (fRec91_2 + (fConst[89] * (fTemp68 + (fConst[91] * fRec91_0)))));
+		ref_meter<M>(6, fTemp69, fRec87_1, iRec88_1, fRec89_1, fConst[1]);
+		double fRec101_0 = (fSlow9 + (0.999 * fRec101_1));
+		double fRec107_0 = (0.0 - (fConst[138] * ((fConst[63] * fRec107_1) - (fConst[122] * (fTemp65 + fVec6_1)))));
+		double fRec106_0 = (fRec107_0 - (fConst[129] * ((fConst[134] * fRec106_2) + (fConst[67] * fRec106_1))));
+		double fTemp72 = (fRec106_2 + (fRec106_0 + (2.0 * fRec106_1)));
+		double fVec7_0 = fTemp72;
+		double fRec105_0 = ((fConst[129] * ((fConst[137] * fTemp72) + (fConst[139] * fVec7_1))) - (fConst[140] * fRec105_1));
+		double fRec104_0 = (fRec105_0 - (fConst[136] * ((fConst[141] * fRec104_2) + (fConst[76] * fRec104_1))));
+		double fTemp73 = (fConst[85] * fRec103_1);
+		double fRec103_0 = ((fConst[136] * (((fConst[75] * fRec104_0) + (fConst[142] * fRec104_1)) + (fConst[75] * fRec104_2))) - (fConst[80] * ((fConst[82] * fRec103_2) + fTemp73)));
+		double fTemp74 = (fConst[94] * fRec102_1);
+		double fRec102_0 = ((fRec103_2 + (fConst[80] * (fTemp73 + (fConst[82] * fRec103_0)))) - (fConst[89] * ((fConst[91] * fRec102_2) + fTemp74)));
+		double fTemp75 = (fRec101_0 * (fRec102_2 + (fConst[89] * (fTemp74 + (fConst[91] * fRec102_0)))));
+		ref_meter<M>(7, fTemp75, fRec98_1, iRec99_1, fRec100_1, fConst[1]);
+		double fRec111_0 = (fSlow10 + (0.999 * fRec111_1));
+		double fRec116_0 = (0.0 - (fConst[145] * ((fConst[72] * fRec116_1) - (fConst[129] * (fTemp72 + fVec7_1)))));
+		double fRec115_0 = (fRec116_0 - (fConst[136] * ((fConst[141] * fRec115_2) + (fConst[76] * fRec115_1))));
+		double fTemp78 = (fRec115_2 + (fRec115_0 + (2.0 * fRec115_1)));
+		double fVec8_0 = fTemp78;
+		double fRec114_0 = ((fConst[136] * ((fConst[144] * fTemp78) + (fConst[146] * fVec8_1))) - (fConst[147] * fRec114_1));
+		double fRec113_0 = (fRec114_0 - (fConst[143] * ((fConst[148] * fRec113_2) + (fConst[85] * fRec113_1))));
+		double fTemp79 = (fConst[94] * fRec112_1);
+		double fRec112_0 = ((fConst[143] * (((fConst[84] * fRec113_0) + (fConst[149] * fRec113_1)) + (fConst[84] * fRec113_2))) - (fConst[89] * ((fConst[91] * fRec112_2) + fTemp79)));
+		double fTemp80 = (fRec111_0 * (fRec112_2 + (fConst[89] * (fTemp79 + (fConst[91] * fRec112_0)))));
+		ref_meter<M>(8, fTemp80, fRec108_1, iRec109_1, fRec110_1, fConst[1]);
+		double fRec120_0 = (fSlow11 + (0.999 * fRec120_1));
+		double fRec124_0 = (0.0 - (fConst[152] * ((fConst[81] * fRec124_1) - (fConst[136] * (fTemp78 + fVec8_1)))));
+		double fRec123_0 = (fRec124_0 - (fConst[143] * ((fConst[148] * fRec123_2) + (fConst[85] * fRec123_1))));
+		double fTemp83 = (fRec123_2 + (fRec123_0 + (2.0 * fRec123_1)));
+		double fVec9_0 = fTemp83;
+		double fRec122_0 = ((fConst[143] * ((fConst[151] * fTemp83) + (fConst[153] * fVec9_1))) - (fConst[154] * fRec122_1));
+		double fRec121_0 = (fRec122_0 - (fConst[150] * ((fConst[155] * fRec121_2) + (fConst[94] * fRec121_1))));
+		double fTemp84 = (fConst[150] * (fRec120_0 * (((fConst[93] * fRec121_0) + (fConst[156] * fRec121_1)) + (fConst[93] * fRec121_2))));
+		ref_meter<M>(9, fTemp84, fRec117_1, iRec118_1, fRec119_1, fConst[1]);
+		double fRec128_0 = (fSlow12 + (0.999 * fRec128_1));
+		double fRec130_0 = (0.0 - (fConst[157] * ((fConst[90] * fRec130_1) - (fConst[143] * (fTemp83 + fVec9_1)))));
+		double fRec129_0 = (fRec130_0 - (fConst[150] * ((fConst[155] * fRec129_2) + (fConst[94] * fRec129_1))));
+		double fTemp87 = (fConst[150] * (fRec128_0 * (fRec129_2 + (fRec129_0 + (2.0 * fRec129_1)))));
+		ref_meter<M>(10, fTemp87, fRec125_1, iRec126_1, fRec127_1, fConst[1]);
+		output0[i] = FAUSTFLOAT((((1.0 - fRec0_0) * fTemp0) + (fRec0_0 * ((((((((((fTemp12 + fTemp24) + fTemp35) + fTemp45) + fTemp54) + fTemp62) + fTemp69) + fTemp75) + fTemp80) + fTemp84) + fTemp87))));
+		fRec0_1 = fRec0_0;
+		fRec4_1 = fRec4_0;
+		fRec16_1 = fRec16_0;
+		fVec0_1 = fVec0_0;
+		fRec15_1 = fRec15_0;
+		fRec14_2 = fRec14_1;
+		fRec14_1 = fRec14_0;
+		fRec13_2 = fRec13_1;
+		fRec13_1 = fRec13_0;
+		fRec12_2 = fRec12_1;
+		fRec12_1 = fRec12_0;
+		fRec11_2 = fRec11_1;
+		fRec11_1 = fRec11_0;
+		fRec10_2 = fRec10_1;
+		fRec10_1 = fRec10_0;
+		fRec9_2 = fRec9_1;
+		fRec9_1 = fRec9_0;
+		fRec8_2 = fRec8_1;
+		fRec8_1 = fRec8_0;
+		fRec7_2 = fRec7_1;
+		fRec7_1 = fRec7_0;
+		fRec6_2 = fRec6_1;
+		fRec6_1 = fRec6_0;
+		fRec5_2 = fRec5_1;
+		fRec5_1 = fRec5_0;
+		fRec20_1 = fRec20_0;
+		fRec32_1 = fRec32_0;
+		fRec31_2 = fRec31_1;
+		fRec31_1 = fRec31_0;
+		fVec1_1 = fVec1_0;
+		fRec30_1 = fRec30_0;
+		fRec29_2 = fRec29_1;
+		fRec29_1 = fRec29_0;
+		fRec28_2 = fRec28_1;
+		fRec28_1 = fRec28_0;
+		fRec27_2 = fRec27_1;
+		fRec27_1 = fRec27_0;
+		fRec26_2 = fRec26_1;
+		fRec26_1 = fRec26_0;
+		fRec25_2 = fRec25_1;
+		fRec25_1 = fRec25_0;
+		fRec24_2 = fRec24_1;
+		fRec24_1 = fRec24_0;
+		fRec23_2 = fRec23_1;
+		fRec23_1 = fRec23_0;
+		fRec22_2 = fRec22_1;
+		fRec22_1 = fRec22_0;
+		fRec21_2 = fRec21_1;
+		fRec21_1 = fRec21_0;
+		fRec36_1 = fRec36_0;
+		fRec47_1 = fRec47_0;
+		fRec46_2 = fRec46_1;
+		fRec46_1 = fRec46_0;
+		fVec2_1 = fVec2_0;
+		fRec45_1 = fRec45_0;
+		fRec44_2 = fRec44_1;
+		fRec44_1 = fRec44_0;
+		fRec43_2 = fRec43_1;
+		fRec43_1 = fRec43_0;
+		fRec42_2 = fRec42_1;
+		fRec42_1 = fRec42_0;
+		fRec41_2 = fRec41_1;
+		fRec41_1 = fRec41_0;
+		fRec40_2 = fRec40_1;
+		fRec40_1 = fRec40_0;
+		fRec39_2 = fRec39_1;
+		fRec39_1 = fRec39_0;
+		fRec38_2 = fRec38_1;
+		fRec38_1 = fRec38_0;
+		fRec37_2 = fRec37_1;
+		fRec37_1 = fRec37_0;
+		fRec51_1 = fRec51_0;
+		fRec61_1 = fRec61_0;
+		fRec60_2 = fRec60_1;
+		fRec60_1 = fRec60_0;
+		fVec3_1 = fVec3_0;
+		fRec59_1 = fRec59_0;
+		fRec58_2 = fRec58_1;
+		fRec58_1 = fRec58_0;
+		fRec57_2 = fRec57_1;
+		fRec57_1 = fRec57_0;
+		fRec56_2 = fRec56_1;
+		fRec56_1 = fRec56_0;
+		fRec55_2 = fRec55_1;
+		fRec55_1 = fRec55_0;
+		fRec54_2 = fRec54_1;
+		fRec54_1 = fRec54_0;
+		fRec53_2 = fRec53_1;
+		fRec53_1 = fRec53_0;
+		fRec52_2 = fRec52_1;
+		fRec52_1 = fRec52_0;
+		fRec65_1 = fRec65_0;
+		fRec74_1 = fRec74_0;
+		fRec73_2 = fRec73_1;
+		fRec73_1 = fRec73_0;
+		fVec4_1 = fVec4_0;
+		fRec72_1 = fRec72_0;
+		fRec71_2 = fRec71_1;
+		fRec71_1 = fRec71_0;
+		fRec70_2 = fRec70_1;
+		fRec70_1 = fRec70_0;
+		fRec69_2 = fRec69_1;
+		fRec69_1 = fRec69_0;
+		fRec68_2 = fRec68_1;
+		fRec68_1 = fRec68_0;
+		fRec67_2 = fRec67_1;
+		fRec67_1 = fRec67_0;
+		fRec66_2 = fRec66_1;
+		fRec66_1 = fRec66_0;
+		fRec78_1 = fRec78_0;
+		fRec86_1 = fRec86_0;
+		fRec85_2 = fRec85_1;
+		fRec85_1 = fRec85_0;
+		fVec5_1 = fVec5_0;
+		fRec84_1 = fRec84_0;
+		fRec83_2 = fRec83_1;
+		fRec83_1 = fRec83_0;
+		fRec82_2 = fRec82_1;
+		fRec82_1 = fRec82_0;
+		fRec81_2 = fRec81_1;
+		fRec81_1 = fRec81_0;
+		fRec80_2 = fRec80_1;
+		fRec80_1 = fRec80_0;
+		fRec79_2 = fRec79_1;
+		fRec79_1 = fRec79_0;
+		fRec90_1 = fRec90_0;
+		fRec97_1 = fRec97_0;
+		fRec96_2 = fRec96_1;
+		fRec96_1 = fRec96_0;
+		fVec6_1 = fVec6_0;
+		fRec95_1 = fRec95_0;
+		fRec94_2 = fRec94_1;
+		fRec94_1 = fRec94_0;
+		fRec93_2 = fRec93_1;
+		fRec93_1 = fRec93_0;
+		fRec92_2 = fRec92_1;
+		fRec92_1 = fRec92_0;
+		fRec91_2 = fRec91_1;
+		fRec91_1 = fRec91_0;
+		fRec101_1 = fRec101_0;
+		fRec107_1 = fRec107_0;
+		fRec106_2 = fRec106_1;
+		fRec106_1 = fRec106_0;
+		fVec7_1 = fVec7_0;
+		fRec105_1 = fRec105_0;
+		fRec104_2 = fRec104_1;
+		fRec104_1 = fRec104_0;
+		fRec103_2 = fRec103_1;
+		fRec103_1 = fRec103_0;
+		fRec102_2 = fRec102_1;
+		fRec102_1 = fRec102_0;
+		fRec111_1 = fRec111_0;
+		fRec116_1 = fRec116_0;
+		fRec115_2 = fRec115_1;
+		fRec115_1 = fRec115_0;
+		fVec8_1 = fVec8_0;
+		fRec114_1 = fRec114_0;
+		fRec113_2 = fRec113_1;
+		fRec113_1 = fRec113_0;
+		fRec112_2 = fRec112_1;
+		fRec112_1 = fRec112_0;
+		fRec120_1 = fRec120_0;
+		fRec124_1 = fRec124_0;
+		fRec123_2 = fRec123_1;
+		fRec123_1 = fRec123_0;
+		fVec9_1 = fVec9_0;
+		fRec122_1 = fRec122_0;
+		fRec121_2 = fRec121_1;
+		fRec121_1 = fRec121_0;
+		fRec128_1 = fRec128_0;
+		fRec130_1 = fRec130_0;
+		fRec129_2 = fRec129_1;
+		fRec129_1 = fRec129_0;
+	}
+	fRec0[1] = fRec0_1;
+	fRec4[1] = fRec4_1;
+	fRec16[1] = fRec16_1;
+	fVec0[1] = fVec0_1;
+	fRec15[1] = fRec15_1;
+	fRec14[1] = fRec14_1; fRec14[2] = fRec14_2;
+	fRec13[1] = fRec13_1; fRec13[2] = fRec13_2;
+	fRec12[1] = fRec12_1; fRec12[2] = fRec12_2;
+	fRec11[1] = fRec11_1; fRec11[2] = fRec11_2;
+	fRec10[1] = fRec10_1; fRec10[2] = fRec10_2;
+	fRec9[1] = fRec9_1; fRec9[2] = fRec9_2;
+	fRec8[1] = fRec8_1; fRec8[2] = fRec8_2;
+	fRec7[1] = fRec7_1; fRec7[2] = fRec7_2;
+	fRec6[1] = fRec6_1; fRec6[2] = fRec6_2;
+	fRec5[1] = fRec5_1; fRec5[2] = fRec5_2;
+	fRec1[1] = fRec1_1;
+	iRec2[1] = iRec2_1;
+	fRec3[1] = fRec3_1;
+	fRec20[1] = fRec20_1;
+	fRec32[1] = fRec32_1;
+	fRec31[1] = fRec31_1; fRec31[2] = fRec31_2;
+	fVec1[1] = fVec1_1;
+	fRec30[1] = fRec30_1;
+	fRec29[1] = fRec29_1; fRec29[2] = fRec29_2;
+	fRec28[1] = fRec28_1; fRec28[2] = fRec28_2;
+	fRec27[1] = fRec27_1; fRec27[2] = fRec27_2;
+	fRec26[1] = fRec26_1; fRec26[2] = fRec26_2;
+	fRec25[1] = fRec25_1; fRec25[2] = fRec25_2;
+	fRec24[1] = fRec24_1; fRec24[2] = fRec24_2;
+	fRec23[1] = fRec23_1; fRec23[2] = fRec23_2;
+	fRec22[1] = fRec22_1; fRec22[2] = fRec22_2;
+	fRec21[1] = fRec21_1; fRec21[2] = fRec21_2;
+	fRec17[1] = fRec17_1;
+	iRec18[1] = iRec18_1;
+	fRec19[1] = fRec19_1;
+	fRec36[1] = fRec36_1;
+	fRec47[1] = fRec47_1;
+	fRec46[1] = fRec46_1; fRec46[2] = fRec46_2;
+	fVec2[1] = fVec2_1;
+	fRec45[1] = fRec45_1;
+	fRec44[1] = fRec44_1; fRec44[2] = fRec44_2;
+	fRec43[1] = fRec43_1; fRec43[2] = fRec43_2;
+	fRec42[1] = fRec42_1; fRec42[2] = fRec42_2;
+	fRec41[1] = fRec41_1; fRec41[2] = fRec41_2;
+	fRec40[1] = fRec40_1; fRec40[2] = fRec40_2;
+	fRec39[1] = fRec39_1; fRec39[2] = fRec39_2;
+	fRec38[1] = fRec38_1; fRec38[2] = fRec38_2;
+	fRec37[1] = fRec37_1; fRec37[2] = fRec37_2;
+	fRec33[1] = fRec33_1;
+	iRec34[1] = iRec34_1;
+	fRec35[1] = fRec35_1;
+	fRec51[1] = fRec51_1;
+	fRec61[1] = fRec61_1;
+	fRec60[1] = fRec60_1; fRec60[2] = fRec60_2;
+	fVec3[1] = fVec3_1;
+	fRec59[1] = fRec59_1;
+	fRec58[1] = fRec58_1; fRec58[2] = fRec58_2;
+	fRec57[1] = fRec57_1; fRec57[2] = fRec57_2;
+	fRec56[1] = fRec56_1; fRec56[2] = fRec56_2;
+	fRec55[1] = fRec55_1; fRec55[2] = fRec55_2;
+	fRec54[1] = fRec54_1; fRec54[2] = fRec54_2;
+	fRec53[1] = fRec53_1; fRec53[2] = fRec53_2;
+	fRec52[1] = fRec52_1; fRec52[2] = fRec52_2;
+	fRec48[1] = fRec48_1;
+	iRec49[1] = iRec49_1;
+	fRec50[1] = fRec50_1;
+	fRec65[1] = fRec65_1;
+	fRec74[1] = fRec74_1;
+	fRec73[1] = fRec73_1; fRec73[2] = fRec73_2;
+	fVec4[1] = fVec4_1;
+	fRec72[1] = fRec72_1;
+	fRec71[1] = fRec71_1; fRec71[2] = fRec71_2;
+	fRec70[1] = fRec70_1; fRec70[2] = fRec70_2;
+	fRec69[1] = fRec69_1; fRec69[2] = fRec69_2;
+	fRec68[1] = fRec68_1; fRec68[2] = fRec68_2;
+	fRec67[1] = fRec67_1; fRec67[2] = fRec67_2;
+	fRec66[1] = fRec66_1; fRec66[2] = fRec66_2;
+	fRec62[1] = fRec62_1;
+	iRec63[1] = iRec63_1;
+	fRec64[1] = fRec64_1;
+	fRec78[1] = fRec78_1;
+	fRec86[1] = fRec86_1;
+	fRec85[1] = fRec85_1; fRec85[2] = fRec85_2;
+	fVec5[1] = fVec5_1;
+	fRec84[1] = fRec84_1;
+	fRec83[1] = fRec83_1; fRec83[2] = fRec83_2;
+	fRec82[1] = fRec82_1; fRec82[2] = fRec82_2;
+	fRec81[1] = fRec81_1; fRec81[2] = fRec81_2;
+	fRec80[1] = fRec80_1; fRec80[2] = fRec80_2;
+	fRec79[1] = fRec79_1; fRec79[2] = fRec79_2;
+	fRec75[1] = fRec75_1;
+	iRec76[1] = iRec76_1;
+	fRec77[1] = fRec77_1;
+	fRec90[1] = fRec90_1;
+	fRec97[1] = fRec97_1;
+	fRec96[1] = fRec96_1; fRec96[2] = fRec96_2;
+	fVec6[1] = fVec6_1;
+	fRec95[1] = fRec95_1;
+	fRec94[1] = fRec94_1; fRec94[2] = fRec94_2;
+	fRec93[1] = fRec93_1; fRec93[2] = fRec93_2;
+	fRec92[1] = fRec92_1; fRec92[2] = fRec92_2;
+	fRec91[1] = fRec91_1; fRec91[2] = fRec91_2;
+	fRec87[1] = fRec87_1;
+	iRec88[1] = iRec88_1;
+	fRec89[1] = fRec89_1;
+	fRec101[1] = fRec101_1;
+	fRec107[1] = fRec107_1;
+	fRec106[1] = fRec106_1; fRec106[2] = fRec106_2;
+	fVec7[1] = fVec7_1;
+	fRec105[1] = fRec105_1;
+	fRec104[1] = fRec104_1; fRec104[2] = fRec104_2;
+	fRec103[1] = fRec103_1; fRec103[2] = fRec103_2;
+	fRec102[1] = fRec102_1; fRec102[2] = fRec102_2;
+	fRec98[1] = fRec98_1;
+	iRec99[1] = iRec99_1;
+	fRec100[1] = fRec100_1;
+	fRec111[1] = fRec111_1;
+	fRec116[1] = fRec116_1;
+	fRec115[1] = fRec115_1; fRec115[2] = fRec115_2;
+	fVec8[1] = fVec8_1;
+	fRec114[1] = fRec114_1;
+	fRec113[1] = fRec113_1; fRec113[2] = fRec113_2;
+	fRec112[1] = fRec112_1; fRec112[2] = fRec112_2;
+	fRec108[1] = fRec108_1;
+	iRec109[1] = iRec109_1;
+	fRec110[1] = fRec110_1;
+	fRec120[1] = fRec120_1;
+	fRec124[1] = fRec124_1;
+	fRec123[1] = fRec123_1; fRec123[2] = fRec123_2;
+	fVec9[1] = fVec9_1;
+	fRec122[1] = fRec122_1;
+	fRec121[1] = fRec121_1; fRec121[2] = fRec121_2;
+	fRec117[1] = fRec117_1;
+	iRec118[1] = iRec118_1;
+	fRec119[1] = fRec119_1;
+	fRec128[1] = fRec128_1;
+	fRec130[1] = fRec130_1;
+	fRec129[1] = fRec129_1; fRec129[2] = fRec129_2;
+	fRec125[1] = fRec125_1;
+	iRec126[1] = iRec126_1;
+	fRec127[1] = fRec127_1;
+	// the meters only want the last sample, the held reading of the window
+	if (M != METER_OFF) {
+		_power0 = FAUSTFLOAT(fRec3[1]);
+		_power1 = FAUSTFLOAT(fRec19[1]);
+		_power2 = FAUSTFLOAT(fRec35[1]);
+		_power3 = FAUSTFLOAT(fRec50[1]);
+		_power4 = FAUSTFLOAT(fRec64[1]);
+		_power5 = FAUSTFLOAT(fRec77[1]);
+		_power6 = FAUSTFLOAT(fRec89[1]);
+		_power7 = FAUSTFLOAT(fRec100[1]);
+		_power8 = FAUSTFLOAT(fRec110[1]);
+		_power9 = FAUSTFLOAT(fRec119[1]);
+		_power10 = FAUSTFLOAT(fRec127[1]);
+	}
+#undef fConst
+}
+
+template <int M>
+inline void Dsp::compute_ref_rate(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0)
+{
+	switch (fRate) {
+	case 0: compute_ref<0, M>(count, input0, output0); break;
+	case 1: compute_ref<1, M>(count, input0, output0); break;
+	case 2: compute_ref<2, M>(count, input0, output0); break;
+	case 3: compute_ref<3, M>(count, input0, output0); break;
+	case 4: compute_ref<4, M>(count, input0, output0); break;
+	default: compute_ref<-1, M>(count, input0, output0); break;
+	}
+}
+
+void always_inline Dsp::compute(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0, bool block)
+{
+	const bool matching = capture();
+	if (idle(count, 1, &input0, &output0)) return;
+	if (matching) fMatchFrames += count;
 #define fVslider0 (*fVslider0_)
 #define fVslider1 (*fVslider1_)
 #define fVslider2 (*fVslider2_)
@@ -765,480 +1817,54 @@ void always_inline Dsp::compute(int count, FAUSTFLOAT *input0, FAUSTFLOAT *outpu
 #define fVslider12 (*fVslider12_)
 #define fVbargraph10 (*fVbargraph10_)
 #define bypass (*bypass_)
-	double fSlow0 = (0.0010000000000000009 * double(fVslider0));
-	double fSlow1 = (0.0010000000000000009 * std::pow(10.0, (0.050000000000000003 * double(fVslider1))));
-	double fSlow2 = (0.0010000000000000009 * std::pow(10.0, (0.050000000000000003 * double(fVslider2))));
-	double fSlow3 = (0.0010000000000000009 * std::pow(10.0, (0.050000000000000003 * double(fVslider3))));
-	double fSlow4 = (0.0010000000000000009 * std::pow(10.0, (0.050000000000000003 * double(fVslider4))));
-	double fSlow5 = (0.0010000000000000009 * std::pow(10.0, (0.050000000000000003 * double(fVslider5))));
-	double fSlow6 = (0.0010000000000000009 * std::pow(10.0, (0.050000000000000003 * double(fVslider6))));
-	double fSlow7 = (0.0010000000000000009 * std::pow(10.0, (0.050000000000000003 * double(fVslider7))));
-	double fSlow8 = (0.0010000000000000009 * std::pow(10.0, (0.050000000000000003 * double(fVslider8))));
-	double fSlow9 = (0.0010000000000000009 * std::pow(10.0, (0.050000000000000003 * double(fVslider9))));
-	double fSlow10 = (0.0010000000000000009 * std::pow(10.0, (0.050000000000000003 * double(fVslider10))));
-	double fSlow11 = (0.0010000000000000009 * std::pow(10.0, (0.050000000000000003 * double(fVslider11))));
-	double fSlow12 = (0.0010000000000000009 * std::pow(10.0, (0.050000000000000003 * double(fVslider12))));
-	for (int i = 0; (i < count); i = (i + 1)) {
-		fRec0[0] = (fSlow0 + (0.999 * fRec0[1]));
-		double fTemp0 = double(input0[i]);
-		int iTemp1 = (iRec2[1] < 4096);
-		fRec4[0] = (fSlow1 + (0.999 * fRec4[1]));
-		fRec16[0] = (fSlow2 + (0.999 * fRec16[1]));
-		double fTemp2 = (fRec16[0] * fTemp0);
-		fVec0[0] = fTemp2;
-		fRec15[0] = ((fConst8 * fVec0[1]) - (fConst9 * ((fConst10 * fRec15[1]) - (fConst3 * fTemp2))));
-		fRec14[0] = (fRec15[0] - (fConst4 * ((fConst11 * fRec14[2]) + (fConst12 * fRec14[1]))));
-		double fTemp3 = (fConst22 * fRec13[1]);
-		fRec13[0] = ((fConst4 * (((fConst6 * fRec14[0]) + (fConst13 * fRec14[1])) + (fConst6 * fRec14[2]))) - (fConst17 * ((fConst19 * fRec13[2]) + fTemp3)));
-		double fTemp4 = (fConst31 * fRec12[1]);
-		fRec12[0] = ((fRec13[2] + (fConst17 * (fTemp3 + (fConst19 * fRec13[0])))) - (fConst26 * ((fConst28 * fRec12[2]) + fTemp4)));
-		double fTemp5 = (fConst40 * fRec11[1]);
-		fRec11[0] = ((fRec12[2] + (fConst26 * (fTemp4 + (fConst28 * fRec12[0])))) - (fConst35 * ((fConst37 * fRec11[2]) + fTemp5)));
-		double fTemp6 = (fConst49 * fRec10[1]);
-		fRec10[0] = ((fRec11[2] + (fConst35 * (fTemp5 + (fConst37 * fRec11[0])))) - (fConst44 * ((fConst46 * fRec10[2]) + fTemp6)));
-		double fTemp7 = (fConst58 * fRec9[1]);
-		fRec9[0] = ((fRec10[2] + (fConst44 * (fTemp6 + (fConst46 * fRec10[0])))) - (fConst53 * ((fConst55 * fRec9[2]) + fTemp7)));
-		double fTemp8 = (fConst67 * fRec8[1]);
-		fRec8[0] = ((fRec9[2] + (fConst53 * (fTemp7 + (fConst55 * fRec9[0])))) - (fConst62 * ((fConst64 * fRec8[2]) + fTemp8)));
-		double fTemp9 = (fConst76 * fRec7[1]);
-		fRec7[0] = ((fRec8[2] + (fConst62 * (fTemp8 + (fConst64 * fRec8[0])))) - (fConst71 * ((fConst73 * fRec7[2]) + fTemp9)));
-		double fTemp10 = (fConst85 * fRec6[1]);
-		fRec6[0] = ((fRec7[2] + (fConst71 * (fTemp9 + (fConst73 * fRec7[0])))) - (fConst80 * ((fConst82 * fRec6[2]) + fTemp10)));
-		double fTemp11 = (fConst94 * fRec5[1]);
-		fRec5[0] = ((fRec6[2] + (fConst80 * (fTemp10 + (fConst82 * fRec6[0])))) - (fConst89 * ((fConst91 * fRec5[2]) + fTemp11)));
-		double fTemp12 = (fRec4[0] * (fRec5[2] + (fConst89 * (fTemp11 + (fConst91 * fRec5[0])))));
-		double fTemp13 = std::max<double>(fConst1, std::fabs(fTemp12));
-		fRec1[0] = (iTemp1?std::max<double>(fRec1[1], fTemp13):fTemp13);
-		iRec2[0] = (iTemp1?(iRec2[1] + 1):1);
-		fRec3[0] = (iTemp1?fRec3[1]:fRec1[1]);
-		_power0 = FAUSTFLOAT(fRec3[0]);
-		int iTemp14 = (iRec18[1] < 4096);
-		fRec20[0] = (fSlow3 + (0.999 * fRec20[1]));
-		fRec32[0] = (0.0 - (fConst9 * ((fConst10 * fRec32[1]) - (fTemp2 + fVec0[1]))));
-		fRec31[0] = (fRec32[0] - (fConst4 * ((fConst11 * fRec31[2]) + (fConst12 * fRec31[1]))));
-		double fTemp15 = (fRec31[2] + (fRec31[0] + (2.0 * fRec31[1])));
-		fVec1[0] = fTemp15;
-		fRec30[0] = ((fConst4 * ((fConst96 * fTemp15) + (fConst97 * fVec1[1]))) - (fConst98 * fRec30[1]));
-		fRec29[0] = (fRec30[0] - (fConst95 * ((fConst99 * fRec29[2]) + (fConst22 * fRec29[1]))));
-		double fTemp16 = (fConst31 * fRec28[1]);
-		fRec28[0] = ((fConst95 * (((fConst21 * fRec29[0]) + (fConst100 * fRec29[1])) + (fConst21 * fRec29[2]))) - (fConst26 * ((fConst28 * fRec28[2]) + fTemp16)));
-		double fTemp17 = (fConst40 * fRec27[1]);
-		fRec27[0] = ((fRec28[2] + (fConst26 * (fTemp16 + (fConst28 * fRec28[0])))) - (fConst35 * ((fConst37 * fRec27[2]) + fTemp17)));
-		double fTemp18 = (fConst49 * fRec26[1]);
-		fRec26[0] = ((fRec27[2] + (fConst35 * (fTemp17 + (fConst37 * fRec27[0])))) - (fConst44 * ((fConst46 * fRec26[2]) + fTemp18)));
-		double fTemp19 = (fConst58 * fRec25[1]);
-		fRec25[0] = ((fRec26[2] + (fConst44 * (fTemp18 + (fConst46 * fRec26[0])))) - (fConst53 * ((fConst55 * fRec25[2]) + fTemp19)));
-		double fTemp20 = (fConst67 * fRec24[1]);
-		fRec24[0] = ((fRec25[2] + (fConst53 * (fTemp19 + (fConst55 * fRec25[0])))) - (fConst62 * ((fConst64 * fRec24[2]) + fTemp20)));
-		double fTemp21 = (fConst76 * fRec23[1]);
-		fRec23[0] = ((fRec24[2] + (fConst62 * (fTemp20 + (fConst64 * fRec24[0])))) - (fConst71 * ((fConst73 * fRec23[2]) + fTemp21)));
-		double fTemp22 = (fConst85 * fRec22[1]);
-		fRec22[0] = ((fRec23[2] + (fConst71 * (fTemp21 + (fConst73 * fRec23[0])))) - (fConst80 * ((fConst82 * fRec22[2]) + fTemp22)));
-		double fTemp23 = (fConst94 * fRec21[1]);
-		fRec21[0] = ((fRec22[2] + (fConst80 * (fTemp22 + (fConst82 * fRec22[0])))) - (fConst89 * ((fConst91 * fRec21[2]) + fTemp23)));
-		double fTemp24 = (fRec20[0] * (fRec21[2] + (fConst89 * (fTemp23 + (fConst91 * fRec21[0])))));
-		double fTemp25 = std::max<double>(fConst1, std::fabs(fTemp24));
-		fRec17[0] = (iTemp14?std::max<double>(fRec17[1], fTemp25):fTemp25);
-		iRec18[0] = (iTemp14?(iRec18[1] + 1):1);
-		fRec19[0] = (iTemp14?fRec19[1]:fRec17[1]);
-		_power1 = FAUSTFLOAT(fRec19[0]);
-		int iTemp26 = (iRec34[1] < 4096);
-		fRec36[0] = (fSlow4 + (0.999 * fRec36[1]));
-		fRec47[0] = (0.0 - (fConst103 * ((fConst18 * fRec47[1]) - (fConst4 * (fTemp15 + fVec1[1])))));
-		fRec46[0] = (fRec47[0] - (fConst95 * ((fConst99 * fRec46[2]) + (fConst22 * fRec46[1]))));
-		double fTemp27 = (fRec46[2] + (fRec46[0] + (2.0 * fRec46[1])));
-		fVec2[0] = fTemp27;
-		fRec45[0] = ((fConst95 * ((fConst102 * fTemp27) + (fConst104 * fVec2[1]))) - (fConst105 * fRec45[1]));
-		fRec44[0] = (fRec45[0] - (fConst101 * ((fConst106 * fRec44[2]) + (fConst31 * fRec44[1]))));
-		double fTemp28 = (fConst40 * fRec43[1]);
-		fRec43[0] = ((fConst101 * (((fConst30 * fRec44[0]) + (fConst107 * fRec44[1])) + (fConst30 * fRec44[2]))) - (fConst35 * ((fConst37 * fRec43[2]) + fTemp28)));
-		double fTemp29 = (fConst49 * fRec42[1]);
-		fRec42[0] = ((fRec43[2] + (fConst35 * (fTemp28 + (fConst37 * fRec43[0])))) - (fConst44 * ((fConst46 * fRec42[2]) + fTemp29)));
-		double fTemp30 = (fConst58 * fRec41[1]);
-		fRec41[0] = ((fRec42[2] + (fConst44 * (fTemp29 + (fConst46 * fRec42[0])))) - (fConst53 * ((fConst55 * fRec41[2]) + fTemp30)));
-		double fTemp31 = (fConst67 * fRec40[1]);
-		fRec40[0] = ((fRec41[2] + (fConst53 * (fTemp30 + (fConst55 * fRec41[0])))) - (fConst62 * ((fConst64 * fRec40[2]) + fTemp31)));
-		double fTemp32 = (fConst76 * fRec39[1]);
-		fRec39[0] = ((fRec40[2] + (fConst62 * (fTemp31 + (fConst64 * fRec40[0])))) - (fConst71 * ((fConst73 * fRec39[2]) + fTemp32)));
-		double fTemp33 = (fConst85 * fRec38[1]);
-		fRec38[0] = ((fRec39[2] + (fConst71 * (fTemp32 + (fConst73 * fRec39[0])))) - (fConst80 * ((fConst82 * fRec38[2]) + fTemp33)));
-		double fTemp34 = (fConst94 * fRec37[1]);
-		fRec37[0] = ((fRec38[2] + (fConst80 * (fTemp33 + (fConst82 * fRec38[0])))) - (fConst89 * ((fConst91 * fRec37[2]) + fTemp34)));
-		double fTemp35 = (fRec36[0] * (fRec37[2] + (fConst89 * (fTemp34 + (fConst91 * fRec37[0])))));
-		double fTemp36 = std::max<double>(fConst1, std::fabs(fTemp35));
-		fRec33[0] = (iTemp26?std::max<double>(fRec33[1], fTemp36):fTemp36);
-		iRec34[0] = (iTemp26?(iRec34[1] + 1):1);
-		fRec35[0] = (iTemp26?fRec35[1]:fRec33[1]);
-		_power2 = FAUSTFLOAT(fRec35[0]);
-		int iTemp37 = (iRec49[1] < 4096);
-		fRec51[0] = (fSlow5 + (0.999 * fRec51[1]));
-		fRec61[0] = (0.0 - (fConst110 * ((fConst27 * fRec61[1]) - (fConst95 * (fTemp27 + fVec2[1])))));
-		fRec60[0] = (fRec61[0] - (fConst101 * ((fConst106 * fRec60[2]) + (fConst31 * fRec60[1]))));
-		double fTemp38 = (fRec60[2] + (fRec60[0] + (2.0 * fRec60[1])));
-		fVec3[0] = fTemp38;
-		fRec59[0] = ((fConst101 * ((fConst109 * fTemp38) + (fConst111 * fVec3[1]))) - (fConst112 * fRec59[1]));
-		fRec58[0] = (fRec59[0] - (fConst108 * ((fConst113 * fRec58[2]) + (fConst40 * fRec58[1]))));
-		double fTemp39 = (fConst49 * fRec57[1]);
-		fRec57[0] = ((fConst108 * (((fConst39 * fRec58[0]) + (fConst114 * fRec58[1])) + (fConst39 * fRec58[2]))) - (fConst44 * ((fConst46 * fRec57[2]) + fTemp39)));
-		double fTemp40 = (fConst58 * fRec56[1]);
-		fRec56[0] = ((fRec57[2] + (fConst44 * (fTemp39 + (fConst46 * fRec57[0])))) - (fConst53 * ((fConst55 * fRec56[2]) + fTemp40)));
-		double fTemp41 = (fConst67 * fRec55[1]);
-		fRec55[0] = ((fRec56[2] + (fConst53 * (fTemp40 + (fConst55 * fRec56[0])))) - (fConst62 * ((fConst64 * fRec55[2]) + fTemp41)));
-		double fTemp42 = (fConst76 * fRec54[1]);
-		fRec54[0] = ((fRec55[2] + (fConst62 * (fTemp41 + (fConst64 * fRec55[0])))) - (fConst71 * ((fConst73 * fRec54[2]) + fTemp42)));
-		double fTemp43 = (fConst85 * fRec53[1]);
-		fRec53[0] = ((fRec54[2] + (fConst71 * (fTemp42 + (fConst73 * fRec54[0])))) - (fConst80 * ((fConst82 * fRec53[2]) + fTemp43)));
-		double fTemp44 = (fConst94 * fRec52[1]);
-		fRec52[0] = ((fRec53[2] + (fConst80 * (fTemp43 + (fConst82 * fRec53[0])))) - (fConst89 * ((fConst91 * fRec52[2]) + fTemp44)));
-		double fTemp45 = (fRec51[0] * (fRec52[2] + (fConst89 * (fTemp44 + (fConst91 * fRec52[0])))));
-		double fTemp46 = std::max<double>(fConst1, std::fabs(fTemp45));
-		fRec48[0] = (iTemp37?std::max<double>(fRec48[1], fTemp46):fTemp46);
-		iRec49[0] = (iTemp37?(iRec49[1] + 1):1);
-		fRec50[0] = (iTemp37?fRec50[1]:fRec48[1]);
-		_power3 = FAUSTFLOAT(fRec50[0]);
-		int iTemp47 = (iRec63[1] < 4096);
-		fRec65[0] = (fSlow6 + (0.999 * fRec65[1]));
-		fRec74[0] = (0.0 - (fConst117 * ((fConst36 * fRec74[1]) - (fConst101 * (fTemp38 + fVec3[1])))));
-		fRec73[0] = (fRec74[0] - (fConst108 * ((fConst113 * fRec73[2]) + (fConst40 * fRec73[1]))));
-		double fTemp48 = (fRec73[2] + (fRec73[0] + (2.0 * fRec73[1])));
-		fVec4[0] = fTemp48;
-		fRec72[0] = ((fConst108 * ((fConst116 * fTemp48) + (fConst118 * fVec4[1]))) - (fConst119 * fRec72[1]));
-		fRec71[0] = (fRec72[0] - (fConst115 * ((fConst120 * fRec71[2]) + (fConst49 * fRec71[1]))));
-		double fTemp49 = (fConst58 * fRec70[1]);
-		fRec70[0] = ((fConst115 * (((fConst48 * fRec71[0]) + (fConst121 * fRec71[1])) + (fConst48 * fRec71[2]))) - (fConst53 * ((fConst55 * fRec70[2]) + fTemp49)));
-		double fTemp50 = (fConst67 * fRec69[1]);
-		fRec69[0] = ((fRec70[2] + (fConst53 * (fTemp49 + (fConst55 * fRec70[0])))) - (fConst62 * ((fConst64 * fRec69[2]) + fTemp50)));
-		double fTemp51 = (fConst76 * fRec68[1]);
-		fRec68[0] = ((fRec69[2] + (fConst62 * (fTemp50 + (fConst64 * fRec69[0])))) - (fConst71 * ((fConst73 * fRec68[2]) + fTemp51)));
-		double fTemp52 = (fConst85 * fRec67[1]);
-		fRec67[0] = ((fRec68[2] + (fConst71 * (fTemp51 + (fConst73 * fRec68[0])))) - (fConst80 * ((fConst82 * fRec67[2]) + fTemp52)));
-		double fTemp53 = (fConst94 * fRec66[1]);
-		fRec66[0] = ((fRec67[2] + (fConst80 * (fTemp52 + (fConst82 * fRec67[0])))) - (fConst89 * ((fConst91 * fRec66[2]) + fTemp53)));
-		double fTemp54 = (fRec65[0] * (fRec66[2] + (fConst89 * (fTemp53 + (fConst91 * fRec66[0])))));
-		double fTemp55 = std::max<double>(fConst1, std::fabs(fTemp54));
-		fRec62[0] = (iTemp47?std::max<double>(fRec62[1], fTemp55):fTemp55);
-		iRec63[0] = (iTemp47?(iRec63[1] + 1):1);
-		fRec64[0] = (iTemp47?fRec64[1]:fRec62[1]);
-		_power4 = FAUSTFLOAT(fRec64[0]);
-		int iTemp56 = (iRec76[1] < 4096);
-		fRec78[0] = (fSlow7 + (0.999 * fRec78[1]));
-		fRec86[0] = (0.0 - (fConst124 * ((fConst45 * fRec86[1]) - (fConst108 * (fTemp48 + fVec4[1])))));
-		fRec85[0] = (fRec86[0] - (fConst115 * ((fConst120 * fRec85[2]) + (fConst49 * fRec85[1]))));
-		double fTemp57 = (fRec85[2] + (fRec85[0] + (2.0 * fRec85[1])));
-		fVec5[0] = fTemp57;
-		fRec84[0] = ((fConst115 * ((fConst123 * fTemp57) + (fConst125 * fVec5[1]))) - (fConst126 * fRec84[1]));
-		fRec83[0] = (fRec84[0] - (fConst122 * ((fConst127 * fRec83[2]) + (fConst58 * fRec83[1]))));
-		double fTemp58 = (fConst67 * fRec82[1]);
-		fRec82[0] = ((fConst122 * (((fConst57 * fRec83[0]) + (fConst128 * fRec83[1])) + (fConst57 * fRec83[2]))) - (fConst62 * ((fConst64 * fRec82[2]) + fTemp58)));
-		double fTemp59 = (fConst76 * fRec81[1]);
-		fRec81[0] = ((fRec82[2] + (fConst62 * (fTemp58 + (fConst64 * fRec82[0])))) - (fConst71 * ((fConst73 * fRec81[2]) + fTemp59)));
-		double fTemp60 = (fConst85 * fRec80[1]);
-		fRec80[0] = ((fRec81[2] + (fConst71 * (fTemp59 + (fConst73 * fRec81[0])))) - (fConst80 * ((fConst82 * fRec80[2]) + fTemp60)));
-		double fTemp61 = (fConst94 * fRec79[1]);
-		fRec79[0] = ((fRec80[2] + (fConst80 * (fTemp60 + (fConst82 * fRec80[0])))) - (fConst89 * ((fConst91 * fRec79[2]) + fTemp61)));
-		double fTemp62 = (fRec78[0] * (fRec79[2] + (fConst89 * (fTemp61 + (fConst91 * fRec79[0])))));
-		double fTemp63 = std::max<double>(fConst1, std::fabs(fTemp62));
-		fRec75[0] = (iTemp56?std::max<double>(fRec75[1], fTemp63):fTemp63);
-		iRec76[0] = (iTemp56?(iRec76[1] + 1):1);
-		fRec77[0] = (iTemp56?fRec77[1]:fRec75[1]);
-		_power5 = FAUSTFLOAT(fRec77[0]);
-		int iTemp64 = (iRec88[1] < 4096);
-		fRec90[0] = (fSlow8 + (0.999 * fRec90[1]));
-		fRec97[0] = (0.0 - (fConst131 * ((fConst54 * fRec97[1]) - (fConst115 * (fTemp57 + fVec5[1])))));
-		fRec96[0] = (fRec97[0] - (fConst122 * ((fConst127 * fRec96[2]) + (fConst58 * fRec96[1]))));
-		double fTemp65 = (fRec96[2] + (fRec96[0] + (2.0 * fRec96[1])));
-		fVec6[0] = fTemp65;
-		fRec95[0] = ((fConst122 * ((fConst130 * fTemp65) + (fConst132 * fVec6[1]))) - (fConst133 * fRec95[1]));
-		fRec94[0] = (fRec95[0] - (fConst129 * ((fConst134 * fRec94[2]) + (fConst67 * fRec94[1]))));
-		double fTemp66 = (fConst76 * fRec93[1]);
-		fRec93[0] = ((fConst129 * (((fConst66 * fRec94[0]) + (fConst135 * fRec94[1])) + (fConst66 * fRec94[2]))) - (fConst71 * ((fConst73 * fRec93[2]) + fTemp66)));
-		double fTemp67 = (fConst85 * fRec92[1]);
-		fRec92[0] = ((fRec93[2] + (fConst71 * (fTemp66 + (fConst73 * fRec93[0])))) - (fConst80 * ((fConst82 * fRec92[2]) + fTemp67)));
-		double fTemp68 = (fConst94 * fRec91[1]);
-		fRec91[0] = ((fRec92[2] + (fConst80 * (fTemp67 + (fConst82 * fRec92[0])))) - (fConst89 * ((fConst91 * fRec91[2]) + fTemp68)));
-		double fTemp69 = (fRec90[0] * (fRec91[2] + (fConst89 * (fTemp68 + (fConst91 * fRec91[0])))));
-		double fTemp70 = std::max<double>(fConst1, std::fabs(fTemp69));
-		fRec87[0] = (iTemp64?std::max<double>(fRec87[1], fTemp70):fTemp70);
-		iRec88[0] = (iTemp64?(iRec88[1] + 1):1);
-		fRec89[0] = (iTemp64?fRec89[1]:fRec87[1]);
-		_power6 = FAUSTFLOAT(fRec89[0]);
-		int iTemp71 = (iRec99[1] < 4096);
-		fRec101[0] = (fSlow9 + (0.999 * fRec101[1]));
-		fRec107[0] = (0.0 - (fConst138 * ((fConst63 * fRec107[1]) - (fConst122 * (fTemp65 + fVec6[1])))));
-		fRec106[0] = (fRec107[0] - (fConst129 * ((fConst134 * fRec106[2]) + (fConst67 * fRec106[1]))));
-		double fTemp72 = (fRec106[2] + (fRec106[0] + (2.0 * fRec106[1])));
-		fVec7[0] = fTemp72;
-		fRec105[0] = ((fConst129 * ((fConst137 * fTemp72) + (fConst139 * fVec7[1]))) - (fConst140 * fRec105[1]));
-		fRec104[0] = (fRec105[0] - (fConst136 * ((fConst141 * fRec104[2]) + (fConst76 * fRec104[1]))));
-		double fTemp73 = (fConst85 * fRec103[1]);
-		fRec103[0] = ((fConst136 * (((fConst75 * fRec104[0]) + (fConst142 * fRec104[1])) + (fConst75 * fRec104[2]))) - (fConst80 * ((fConst82 * fRec103[2]) + fTemp73)));
-		double fTemp74 = (fConst94 * fRec102[1]);
-		fRec102[0] = ((fRec103[2] + (fConst80 * (fTemp73 + (fConst82 * fRec103[0])))) - (fConst89 * ((fConst91 * fRec102[2]) + fTemp74)));
-		double fTemp75 = (fRec101[0] * (fRec102[2] + (fConst89 * (fTemp74 + (fConst91 * fRec102[0])))));
-		double fTemp76 = std::max<double>(fConst1, std::fabs(fTemp75));
-		fRec98[0] = (iTemp71?std::max<double>(fRec98[1], fTemp76):fTemp76);
-		iRec99[0] = (iTemp71?(iRec99[1] + 1):1);
-		fRec100[0] = (iTemp71?fRec100[1]:fRec98[1]);
-		_power7 = FAUSTFLOAT(fRec100[0]);
-		int iTemp77 = (iRec109[1] < 4096);
-		fRec111[0] = (fSlow10 + (0.999 * fRec111[1]));
-		fRec116[0] = (0.0 - (fConst145 * ((fConst72 * fRec116[1]) - (fConst129 * (fTemp72 + fVec7[1])))));
-		fRec115[0] = (fRec116[0] - (fConst136 * ((fConst141 * fRec115[2]) + (fConst76 * fRec115[1]))));
-		double fTemp78 = (fRec115[2] + (fRec115[0] + (2.0 * fRec115[1])));
-		fVec8[0] = fTemp78;
-		fRec114[0] = ((fConst136 * ((fConst144 * fTemp78) + (fConst146 * fVec8[1]))) - (fConst147 * fRec114[1]));
-		fRec113[0] = (fRec114[0] - (fConst143 * ((fConst148 * fRec113[2]) + (fConst85 * fRec113[1]))));
-		double fTemp79 = (fConst94 * fRec112[1]);
-		fRec112[0] = ((fConst143 * (((fConst84 * fRec113[0]) + (fConst149 * fRec113[1])) + (fConst84 * fRec113[2]))) - (fConst89 * ((fConst91 * fRec112[2]) + fTemp79)));
-		double fTemp80 = (fRec111[0] * (fRec112[2] + (fConst89 * (fTemp79 + (fConst91 * fRec112[0])))));
-		double fTemp81 = std::max<double>(fConst1, std::fabs(fTemp80));
-		fRec108[0] = (iTemp77?std::max<double>(fRec108[1], fTemp81):fTemp81);
-		iRec109[0] = (iTemp77?(iRec109[1] + 1):1);
-		fRec110[0] = (iTemp77?fRec110[1]:fRec108[1]);
-		_power8 = FAUSTFLOAT(fRec110[0]);
-		int iTemp82 = (iRec118[1] < 4096);
-		fRec120[0] = (fSlow11 + (0.999 * fRec120[1]));
-		fRec124[0] = (0.0 - (fConst152 * ((fConst81 * fRec124[1]) - (fConst136 * (fTemp78 + fVec8[1])))));
-		fRec123[0] = (fRec124[0] - (fConst143 * ((fConst148 * fRec123[2]) + (fConst85 * fRec123[1]))));
-		double fTemp83 = (fRec123[2] + (fRec123[0] + (2.0 * fRec123[1])));
-		fVec9[0] = fTemp83;
-		fRec122[0] = ((fConst143 * ((fConst151 * fTemp83) + (fConst153 * fVec9[1]))) - (fConst154 * fRec122[1]));
-		fRec121[0] = (fRec122[0] - (fConst150 * ((fConst155 * fRec121[2]) + (fConst94 * fRec121[1]))));
-		double fTemp84 = (fConst150 * (fRec120[0] * (((fConst93 * fRec121[0]) + (fConst156 * fRec121[1])) + (fConst93 * fRec121[2]))));
-		double fTemp85 = std::max<double>(fConst1, std::fabs(fTemp84));
-		fRec117[0] = (iTemp82?std::max<double>(fRec117[1], fTemp85):fTemp85);
-		iRec118[0] = (iTemp82?(iRec118[1] + 1):1);
-		fRec119[0] = (iTemp82?fRec119[1]:fRec117[1]);
-		_power9 = FAUSTFLOAT(fRec119[0]);
-		int iTemp86 = (iRec126[1] < 4096);
-		fRec128[0] = (fSlow12 + (0.999 * fRec128[1]));
-		fRec130[0] = (0.0 - (fConst157 * ((fConst90 * fRec130[1]) - (fConst143 * (fTemp83 + fVec9[1])))));
-		fRec129[0] = (fRec130[0] - (fConst150 * ((fConst155 * fRec129[2]) + (fConst94 * fRec129[1]))));
-		double fTemp87 = (fConst150 * (fRec128[0] * (fRec129[2] + (fRec129[0] + (2.0 * fRec129[1])))));
-		double fTemp88 = std::max<double>(fConst1, std::fabs(fTemp87));
-		fRec125[0] = (iTemp86?std::max<double>(fRec125[1], fTemp88):fTemp88);
-		iRec126[0] = (iTemp86?(iRec126[1] + 1):1);
-		fRec127[0] = (iTemp86?fRec127[1]:fRec125[1]);
-		_power10 = FAUSTFLOAT(fRec127[0]);
-		output0[i] = FAUSTFLOAT((((1.0 - fRec0[0]) * fTemp0) + (fRec0[0] * ((((((((((fTemp12 + fTemp24) + fTemp35) + fTemp45) + fTemp54) + fTemp62) + fTemp69) + fTemp75) + fTemp80) + fTemp84) + fTemp87))));
-		fRec0[1] = fRec0[0];
-		fRec4[1] = fRec4[0];
-		fRec16[1] = fRec16[0];
-		fVec0[1] = fVec0[0];
-		fRec15[1] = fRec15[0];
-		fRec14[2] = fRec14[1];
-		fRec14[1] = fRec14[0];
-		fRec13[2] = fRec13[1];
-		fRec13[1] = fRec13[0];
-		fRec12[2] = fRec12[1];
-		fRec12[1] = fRec12[0];
-		fRec11[2] = fRec11[1];
-		fRec11[1] = fRec11[0];
-		fRec10[2] = fRec10[1];
-		fRec10[1] = fRec10[0];
-		fRec9[2] = fRec9[1];
-		fRec9[1] = fRec9[0];
-		fRec8[2] = fRec8[1];
-		fRec8[1] = fRec8[0];
-		fRec7[2] = fRec7[1];
-		fRec7[1] = fRec7[0];
-		fRec6[2] = fRec6[1];
-		fRec6[1] = fRec6[0];
-		fRec5[2] = fRec5[1];
-		fRec5[1] = fRec5[0];
-		fRec1[1] = fRec1[0];
-		iRec2[1] = iRec2[0];
-		fRec3[1] = fRec3[0];
-		fRec20[1] = fRec20[0];
-		fRec32[1] = fRec32[0];
-		fRec31[2] = fRec31[1];
-		fRec31[1] = fRec31[0];
-		fVec1[1] = fVec1[0];
-		fRec30[1] = fRec30[0];
-		fRec29[2] = fRec29[1];
-		fRec29[1] = fRec29[0];
-		fRec28[2] = fRec28[1];
-		fRec28[1] = fRec28[0];
-		fRec27[2] = fRec27[1];
-		fRec27[1] = fRec27[0];
-		fRec26[2] = fRec26[1];
-		fRec26[1] = fRec26[0];
-		fRec25[2] = fRec25[1];
-		fRec25[1] = fRec25[0];
-		fRec24[2] = fRec24[1];
-		fRec24[1] = fRec24[0];
-		fRec23[2] = fRec23[1];
-		fRec23[1] = fRec23[0];
-		fRec22[2] = fRec22[1];
-		fRec22[1] = fRec22[0];
-		fRec21[2] = fRec21[1];
-		fRec21[1] = fRec21[0];
-		fRec17[1] = fRec17[0];
-		iRec18[1] = iRec18[0];
-		fRec19[1] = fRec19[0];
-		fRec36[1] = fRec36[0];
-		fRec47[1] = fRec47[0];
-		fRec46[2] = fRec46[1];
-		fRec46[1] = fRec46[0];
-		fVec2[1] = fVec2[0];
-		fRec45[1] = fRec45[0];
-		fRec44[2] = fRec44[1];
-		fRec44[1] = fRec44[0];
-		fRec43[2] = fRec43[1];
-		fRec43[1] = fRec43[0];
-		fRec42[2] = fRec42[1];
-		fRec42[1] = fRec42[0];
-		fRec41[2] = fRec41[1];
-		fRec41[1] = fRec41[0];
-		fRec40[2] = fRec40[1];
-		fRec40[1] = fRec40[0];
-		fRec39[2] = fRec39[1];
-		fRec39[1] = fRec39[0];
-		fRec38[2] = fRec38[1];
-		fRec38[1] = fRec38[0];
-		fRec37[2] = fRec37[1];
-		fRec37[1] = fRec37[0];
-		fRec33[1] = fRec33[0];
-		iRec34[1] = iRec34[0];
-		fRec35[1] = fRec35[0];
-		fRec51[1] = fRec51[0];
-		fRec61[1] = fRec61[0];
-		fRec60[2] = fRec60[1];
-		fRec60[1] = fRec60[0];
-		fVec3[1] = fVec3[0];
-		fRec59[1] = fRec59[0];
-		fRec58[2] = fRec58[1];
-		fRec58[1] = fRec58[0];
-		fRec57[2] = fRec57[1];
-		fRec57[1] = fRec57[0];
-		fRec56[2] = fRec56[1];
-		fRec56[1] = fRec56[0];
-		fRec55[2] = fRec55[1];
-		fRec55[1] = fRec55[0];
-		fRec54[2] = fRec54[1];
-		fRec54[1] = fRec54[0];
-		fRec53[2] = fRec53[1];
-		fRec53[1] = fRec53[0];
-		fRec52[2] = fRec52[1];
-		fRec52[1] = fRec52[0];
-		fRec48[1] = fRec48[0];
-		iRec49[1] = iRec49[0];
-		fRec50[1] = fRec50[0];
-		fRec65[1] = fRec65[0];
-		fRec74[1] = fRec74[0];
-		fRec73[2] = fRec73[1];
-		fRec73[1] = fRec73[0];
-		fVec4[1] = fVec4[0];
-		fRec72[1] = fRec72[0];
-		fRec71[2] = fRec71[1];
-		fRec71[1] = fRec71[0];
-		fRec70[2] = fRec70[1];
-		fRec70[1] = fRec70[0];
-		fRec69[2] = fRec69[1];
-		fRec69[1] = fRec69[0];
-		fRec68[2] = fRec68[1];
-		fRec68[1] = fRec68[0];
-		fRec67[2] = fRec67[1];
-		fRec67[1] = fRec67[0];
-		fRec66[2] = fRec66[1];
-		fRec66[1] = fRec66[0];
-		fRec62[1] = fRec62[0];
-		iRec63[1] = iRec63[0];
-		fRec64[1] = fRec64[0];
-		fRec78[1] = fRec78[0];
-		fRec86[1] = fRec86[0];
-		fRec85[2] = fRec85[1];
-		fRec85[1] = fRec85[0];
-		fVec5[1] = fVec5[0];
-		fRec84[1] = fRec84[0];
-		fRec83[2] = fRec83[1];
-		fRec83[1] = fRec83[0];
-		fRec82[2] = fRec82[1];
-		fRec82[1] = fRec82[0];
-		fRec81[2] = fRec81[1];
-		fRec81[1] = fRec81[0];
-		fRec80[2] = fRec80[1];
-		fRec80[1] = fRec80[0];
-		fRec79[2] = fRec79[1];
-		fRec79[1] = fRec79[0];
-		fRec75[1] = fRec75[0];
-		iRec76[1] = iRec76[0];
-		fRec77[1] = fRec77[0];
-		fRec90[1] = fRec90[0];
-		fRec97[1] = fRec97[0];
-		fRec96[2] = fRec96[1];
-		fRec96[1] = fRec96[0];
-		fVec6[1] = fVec6[0];
-		fRec95[1] = fRec95[0];
-		fRec94[2] = fRec94[1];
-		fRec94[1] = fRec94[0];
-		fRec93[2] = fRec93[1];
-		fRec93[1] = fRec93[0];
-		fRec92[2] = fRec92[1];
-		fRec92[1] = fRec92[0];
-		fRec91[2] = fRec91[1];
-		fRec91[1] = fRec91[0];
-		fRec87[1] = fRec87[0];
-		iRec88[1] = iRec88[0];
-		fRec89[1] = fRec89[0];
-		fRec101[1] = fRec101[0];
-		fRec107[1] = fRec107[0];
-		fRec106[2] = fRec106[1];
-		fRec106[1] = fRec106[0];
-		fVec7[1] = fVec7[0];
-		fRec105[1] = fRec105[0];
-		fRec104[2] = fRec104[1];
-		fRec104[1] = fRec104[0];
-		fRec103[2] = fRec103[1];
-		fRec103[1] = fRec103[0];
-		fRec102[2] = fRec102[1];
-		fRec102[1] = fRec102[0];
-		fRec98[1] = fRec98[0];
-		iRec99[1] = iRec99[0];
-		fRec100[1] = fRec100[0];
-		fRec111[1] = fRec111[0];
-		fRec116[1] = fRec116[0];
-		fRec115[2] = fRec115[1];
-		fRec115[1] = fRec115[0];
-		fVec8[1] = fVec8[0];
-		fRec114[1] = fRec114[0];
-		fRec113[2] = fRec113[1];
-		fRec113[1] = fRec113[0];
-		fRec112[2] = fRec112[1];
-		fRec112[1] = fRec112[0];
-		fRec108[1] = fRec108[0];
-		iRec109[1] = iRec109[0];
-		fRec110[1] = fRec110[0];
-		fRec120[1] = fRec120[0];
-		fRec124[1] = fRec124[0];
-		fRec123[2] = fRec123[1];
-		fRec123[1] = fRec123[0];
-		fVec9[1] = fVec9[0];
-		fRec122[1] = fRec122[0];
-		fRec121[2] = fRec121[1];
-		fRec121[1] = fRec121[0];
-		fRec117[1] = fRec117[0];
-		iRec118[1] = iRec118[0];
-		fRec119[1] = fRec119[0];
-		fRec128[1] = fRec128[0];
-		fRec130[1] = fRec130[0];
-		fRec129[2] = fRec129[1];
-		fRec129[1] = fRec129[0];
-		fRec125[1] = fRec125[0];
-		iRec126[1] = iRec126[0];
-		fRec127[1] = fRec127[0];
+	set_ramps();
+	const int mode = set_meter(matching);
+	if (matching) fSpec.push(count, input0, fRamp.target(RAMP_INGAIN));
+	if (fEngine) {
+		const double fGainBand[BANK_BANDS] = {fVslider1, fVslider3, fVslider4, fVslider5,
+			fVslider6, fVslider7, fVslider8, fVslider9, fVslider10, fVslider11, fVslider12};
+		// the crossover only runs for the meters while matching
+		const bool meter = mode != METER_OFF && ((fEngine != 4) || matching);
+		// the fast path of engine 1 and 2 has no crossover to meter, it
+		// only runs with the band meters off, so not while matching either
+		const bool flat = (fEngine == 1 || fEngine == 2) && mode == METER_OFF &&
+			(!flat_ || int(*flat_) > 0);
+		if (fEngine == 4) fFit.update(fGainBand);
+		else if (fEngine == 3) fFir.update(fGainBand);
+		// linear phase and fitted run the crossover for the band meters
+		// alongside, a part at a time
+		const int seg = ((fEngine == 3) || (fEngine == 4 && meter) || flat || fFlat != FLAT_OFF)
+			? FIR_PART : count;
+		FAUSTFLOAT fTree[FIR_PART];
+		BankParam p;
+		for (int i = 0, n; i < count; i += n) {
+			n = fRamp.next(std::min<int>(count - i, seg), p);
+			if (fEngine == 4) {
+				if (meter) fBank.compute_tree(n, input0 + i, fTree, p);
+				fFit.compute(n, input0 + i, output0 + i, p);
+			} else if (fEngine == 3) {
+				if (meter) fBank.compute_tree(n, input0 + i, fTree, p);
+				fFir.compute(n, input0 + i, output0 + i, p);
+			} else if (fEngine == 5)
+				fBank.compute_multirate(n, input0 + i, output0 + i, p);
+			else if (fFlat != FLAT_OFF || (flat && bank_flat(p)))
+				run_flat(n, input0 + i, output0 + i, p, block, flat);
+			else
+				run_bank(n, input0 + i, output0 + i, p, block);
+		}
+		if (!meter) fBank.clear_power();
+		bank_power();
+	} else switch (mode) {
+	case METER_OFF: compute_ref_rate<METER_OFF>(count, input0, output0); break;
+	case METER_PEAK: compute_ref_rate<METER_PEAK>(count, input0, output0); break;
+	case METER_RMS: compute_ref_rate<METER_RMS>(count, input0, output0); break;
+	default: compute_ref_rate<METER_MATCH>(count, input0, output0); break;
 	}
-	fVbargraph0 = (bypass? FAUSTFLOAT(20.*log10(_power0+anti_denormal)) : db_zero);
-	fVbargraph1 = (bypass? FAUSTFLOAT(20.*log10(_power1+anti_denormal)) : db_zero);
-	fVbargraph2 = (bypass? FAUSTFLOAT(20.*log10(_power2+anti_denormal)) : db_zero);
-	fVbargraph3 = (bypass? FAUSTFLOAT(20.*log10(_power3+anti_denormal)) : db_zero);
-	fVbargraph4 = (bypass? FAUSTFLOAT(20.*log10(_power4+anti_denormal)) : db_zero);
-	fVbargraph5 = (bypass? FAUSTFLOAT(20.*log10(_power5+anti_denormal)) : db_zero);
-	fVbargraph6 = (bypass? FAUSTFLOAT(20.*log10(_power6+anti_denormal)) : db_zero);
-	fVbargraph7 = (bypass? FAUSTFLOAT(20.*log10(_power7+anti_denormal)) : db_zero);
-	fVbargraph8 = (bypass? FAUSTFLOAT(20.*log10(_power8+anti_denormal)) : db_zero);
-	fVbargraph9 = (bypass? FAUSTFLOAT(20.*log10(_power9+anti_denormal)) : db_zero);
-	fVbargraph10 = (bypass? FAUSTFLOAT(20.*log10(_power10+anti_denormal)) : db_zero);
+	// no log10 while nobody looks
+	if (mode == METER_OFF) report_idle();
+	else report();
+	if (latency_) *latency_ = FAUSTFLOAT(latency());
+	settle(count, 1, &output0, latency());
 
 #undef bypass
 #undef fVslider0
@@ -1269,7 +1895,50 @@ void always_inline Dsp::compute(int count, FAUSTFLOAT *input0, FAUSTFLOAT *outpu
 
 void __rt_func Dsp::compute_static(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0, PluginLV2 *p)
 {
-	static_cast<Dsp*>(p)->compute(count, input0, output0);
+	static_cast<Dsp*>(p)->compute(count, input0, output0, false);
+}
+
+// Stereo and multichannel plugins. All engines run the tree with the
+// channels in the vector lanes, so there is no latency.
+void always_inline Dsp::compute_multi(int count, int channels, FAUSTFLOAT **inputs, FAUSTFLOAT **outputs)
+{
+	const bool matching = capture();
+	if (idle(count, channels, inputs, outputs)) return;
+	if (matching) fMatchFrames += count;
+	set_ramps();
+	const int mode = set_meter(matching);
+	const int analysis = analysis_ ? std::max<int>(0, int(*analysis_)) : 0;
+	if (matching) fSpec.push_channels(count, channels, inputs, analysis, fRamp.target(RAMP_INGAIN));
+	BankParam p;
+	FAUSTFLOAT *in[BANK_CHANNELS];
+	FAUSTFLOAT *out[BANK_CHANNELS];
+	for (int i = 0, n; i < count; i += n) {
+		n = fRamp.next(count - i, p);
+		for (int c = 0; c < channels; c++) {
+			in[c] = inputs[c] + i;
+			out[c] = outputs[c] + i;
+		}
+		fBank.compute_channels(n, channels, in, out, p, analysis);
+	}
+	if (mode == METER_OFF) {
+		report_idle();
+	} else {
+		bank_power();
+		report();
+	}
+	if (latency_) *latency_ = FAUSTFLOAT(0);
+	settle(count, channels, outputs, 0);
+}
+
+void __rt_func Dsp::compute_multi_static(int count, int channels, FAUSTFLOAT **inputs,
+                                         FAUSTFLOAT **outputs, PluginLV2 *p)
+{
+	static_cast<Dsp*>(p)->compute_multi(count, channels, inputs, outputs);
+}
+
+void __rt_func Dsp::compute_block_static(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0, PluginLV2 *p)
+{
+	static_cast<Dsp*>(p)->compute(count, input0, output0, true);
 }
 
 
@@ -1283,6 +1952,36 @@ void Dsp::connect(uint32_t port,void* data)
 	case MORPH: 
 		fVslider0_ = (float*)data; // , 1.0, 0.0, 1.0, 0.10000000000000001 
 		break;
+	case ENGINE: 
+		engine_ = (float*)data; // , 1.0, 0.0, 1.0, 1.0 
+		break;
+	case LATENCY: 
+		latency_ = (float*)data; // , 0.0, 0.0, 65536.0, 1.0 
+		break;
+	case MATCH1: 
+		match1_ = (float*)data; // , 0.0, 0.0, 1.0, 1.0 
+		break;
+	case MATCH2: 
+		match2_ = (float*)data; // , 0.0, 0.0, 1.0, 1.0 
+		break;
+	case ANALYSIS: 
+		analysis_ = (float*)data; // , 0.0, 0.0, 8.0, 1.0 
+		break;
+	case SKIPPED: 
+		skipped_ = (float*)data; // , 0.0, 0.0, 16777215.0, 1.0 
+		break;
+	case FLAT: 
+		flat_ = (float*)data; // , 1.0, 0.0, 2.0, 1.0 
+		break;
+	case METER_MODE: 
+		meter_ = (float*)data; // , 1.0, 0.0, 2.0, 1.0 
+		break;
+	case METER_MS: 
+		meter_ms_ = (float*)data; // , 85.0, 10.0, 1000.0, 1.0 
+		break;
+	case RESOLUTION: 
+		resolution_ = (float*)data; // , 6.0, 6.0, 12.0, 1.0 
+		break;
 	case G10: 
 		fVslider3_ = (float*)data; // , 0.0, -30.0, 5.2000000000000002, 0.10000000000000001 
 		break;
@@ -1367,9 +2066,272 @@ PluginLV2 *plugin() {
 	return new Dsp();
 }
 
+static_assert(alignof(Dsp) <= MEM_ALIGN, "place() gets memory at MEM_ALIGN");
+
+size_t size() {
+	return sizeof(Dsp);
+}
+
+// linear phase at its longest, the multirate engine stays below
+int max_latency(uint32_t rate) {
+	const double fs = std::min<double>(192000.0, std::max<double>(1.0, double(rate)));
+	const int r = fir_scale(fs);
+	return std::max<int>(FIR_TAPS * r / 2 + FIR_PART * r, MR_TAPS - 1);
+}
+
+// the wrapper keeps the dsp class in the memory of its instance
+PluginLV2 *place(void *mem) {
+	Dsp *d = new (mem) Dsp();
+	d->fPlaced = true;
+	return d;
+}
+
 void Dsp::del_instance(PluginLV2 *p)
 {
-	delete static_cast<Dsp*>(p);
+	Dsp *d = static_cast<Dsp*>(p);
+	if (d->fPlaced)
+		d->~Dsp();
+	else
+		delete d;
+}
+
+// Many instances in one call, for hosts which run the EQ on every channel
+// strip of a console. The instances are the ones of plugin(), after
+// set_samplerate() and connect_ports(); their ports are read in compute()
+// like in run(), the meter and latency ports written. Instances at the
+// same sample rate share one set of tree coefficients and run four to a
+// vector, each with its own parameters. The filter state of the instances
+// lives here in lane order, so while an instance is in a batch it must
+// not be run on its own. Like the multichannel plugins, all engines run
+// the tree without latency.
+class Batch : public BatchLV2 {
+private:
+	Dsp **fDsp;
+	int *fLane;          // lane of instance k
+	FAUSTFLOAT **fIn;    // buffers by lane
+	FAUSTFLOAT **fOut;
+	int fInstances;
+	int fLanes;
+	BankBatch fBank;
+
+	void mem_free();
+	bool setup(PluginLV2 **instances, int count);
+	void clear_state_f();
+	void compute(int count, FAUSTFLOAT **inputs, FAUSTFLOAT **outputs);
+
+	static void compute_static(int count, FAUSTFLOAT **inputs, FAUSTFLOAT **outputs, BatchLV2 *b);
+	static void clear_state_static(BatchLV2 *b);
+	static void del_batch(BatchLV2 *b);
+
+public:
+	Batch();
+	friend BatchLV2 *batch(PluginLV2 **instances, int count);
+};
+
+Batch::Batch()
+	: BatchLV2(), fDsp(0), fLane(0), fIn(0), fOut(0), fInstances(0), fLanes(0) {
+	batch_audio = compute_static;
+	clear_state = clear_state_static;
+	delete_batch = del_batch;
+}
+
+void Batch::mem_free()
+{
+	mem_put(fDsp);
+	mem_put(fLane);
+	mem_put(fIn);
+	mem_put(fOut);
+	fDsp = 0;
+	fLane = 0;
+	fIn = 0;
+	fOut = 0;
+	fInstances = 0;
+	fLanes = 0;
+	fBank.mem_free();
+}
+
+// not from the audio thread, allocates
+bool Batch::setup(PluginLV2 **instances, int count)
+{
+	mem_free();
+	if (count <= 0) return false;
+	fDsp = mem_new<Dsp*>(count);
+	fLane = mem_new<int>(count);
+	for (int k = 0; k < count; k++) {
+		fDsp[k] = static_cast<Dsp*>(instances[k]);
+		fLane[k] = -1;
+	}
+	fInstances = count;
+	// the instances of one rate fill whole blocks, in the order given
+	int blocks = 0;
+	for (int k = 0; k < count; k++) {
+		if (fLane[k] >= 0) continue;
+		int n = 0;
+		for (int j = k; j < count; j++) {
+			if (fLane[j] < 0 && fDsp[j]->fSamplingFreq == fDsp[k]->fSamplingFreq) {
+				fLane[j] = blocks * BATCH_LANES + n++;
+			}
+		}
+		blocks += (n + BATCH_LANES - 1) / BATCH_LANES;
+	}
+	fLanes = blocks * BATCH_LANES;
+	fIn = mem_new<FAUSTFLOAT*>(fLanes);
+	fOut = mem_new<FAUSTFLOAT*>(fLanes);
+	for (int l = 0; l < fLanes; l++) {
+		fIn[l] = 0;
+		fOut[l] = 0;
+	}
+	if (!fBank.mem_alloc(blocks)) {
+		mem_free();
+		return false;
+	}
+	for (int k = 0; k < count; k++) {
+		fBank.set_rate(fLane[k] / BATCH_LANES, fDsp[k]->fBank);
+	}
+	clear_state_f();
+	return true;
+}
+
+void Batch::clear_state_f()
+{
+	fBank.clear_state();
+	for (int k = 0; k < fInstances; k++) fDsp[k]->fRamp.clear();
+}
+
+void __rt_func Batch::compute(int count, FAUSTFLOAT **inputs, FAUSTFLOAT **outputs)
+{
+	for (int k = 0; k < fInstances; k++) fDsp[k]->set_ramps();
+	BankParam p;
+	for (int i = 0, n; i < count; i += n) {
+		// the stretch ends where the first ramp of any instance ends
+		n = count - i;
+		for (int k = 0; k < fInstances; k++) n = fDsp[k]->fRamp.stretch(n);
+		bool ramp = false;
+		for (int k = 0; k < fInstances; k++) {
+			fDsp[k]->fRamp.next(n, p);
+			fBank.set_param(fLane[k], p);
+			fIn[fLane[k]] = inputs[k] + i;
+			fOut[fLane[k]] = outputs[k] + i;
+			ramp |= p.ramp;
+		}
+		fBank.compute(n, fIn, fOut, ramp);
+	}
+	for (int k = 0; k < fInstances; k++) {
+		Dsp *d = fDsp[k];
+		for (int b = 0; b < BANK_BANDS; b++) d->fBank.set_power(b, fBank.power(fLane[k], b));
+		d->bank_power();
+		d->report();
+		if (d->latency_) *d->latency_ = FAUSTFLOAT(0);
+	}
+}
+
+void __rt_func Batch::compute_static(int count, FAUSTFLOAT **inputs, FAUSTFLOAT **outputs, BatchLV2 *b)
+{
+	static_cast<Batch*>(b)->compute(count, inputs, outputs);
+}
+
+void Batch::clear_state_static(BatchLV2 *b)
+{
+	static_cast<Batch*>(b)->clear_state_f();
+}
+
+void Batch::del_batch(BatchLV2 *b)
+{
+	Batch *self = static_cast<Batch*>(b);
+	self->mem_free();
+	mem_put(self);
+}
+
+// a batch of instances of plugin(), 0 when there is nothing to run
+BatchLV2 *batch(PluginLV2 **instances, int count)
+{
+	Batch *b = mem_new<Batch>(1);
+	if (!b->setup(instances, count)) {
+		Batch::del_batch(b);
+		return 0;
+	}
+	return b;
+}
+
+int Dsp::activate_static(bool start, PluginLV2 *p)
+{
+	// the buffers of the linear phase mode and of the analysis, which
+	// only runs with the worker thread
+	Dsp *self = static_cast<Dsp*>(p);
+	if (start) {
+		self->fFir.mem_alloc();
+		if (self->work) self->fSpec.mem_alloc();
+	} else {
+		self->fFir.mem_free();
+		self->fSpec.mem_free();
+		self->fMatchWait = 0;
+	}
+	return 0;
+}
+
+int Dsp::match_spectrum_static(float *levels, PluginLV2 *p)
+{
+	Dsp *self = static_cast<Dsp*>(p);
+	const int m = self->fMatchDone;
+	if (m) {
+		for (int b = 0; b < BANK_BANDS; b++) levels[b] = self->fMatchDb[b];
+		self->fMatchDone = 0;
+	}
+	return m;
+}
+
+int Dsp::get_latency_static(PluginLV2 *p)
+{
+	return static_cast<Dsp*>(p)->latency();
+}
+
+int Dsp::match_detail_static(float *levels, PluginLV2 *p)
+{
+	Dsp *self = static_cast<Dsp*>(p);
+	const int n = self->fSpecDone;
+	for (int j = 0; j < n; j++) levels[j] = self->fSpecDb[j];
+	self->fSpecDone = 0;
+	return n;
+}
+
+// one job per request, each engine gets its own
+uint32_t Dsp::work_pending_static(PluginLV2 *p)
+{
+	Dsp *self = static_cast<Dsp*>(p);
+	uint32_t seq;
+	if ((seq = self->fFir.work_pending())) return JOB_FIR | (seq << 8);
+	if ((seq = self->fFit.work_pending())) return JOB_FIT | (seq << 8);
+	if ((seq = self->fSpec.work_pending())) return JOB_SPEC | (seq << 8);
+	return JOB_NONE;
+}
+
+void Dsp::work_static(uint32_t job, PluginLV2 *p)
+{
+	Dsp *self = static_cast<Dsp*>(p);
+	switch (JOB_KIND(job)) {
+	case JOB_FIR: self->fFir.work(JOB_SEQ(job)); break;
+	case JOB_FIT: self->fFit.work(JOB_SEQ(job)); break;
+	case JOB_SPEC: self->fSpec.work(JOB_SEQ(job)); break;
+	default: break;
+	}
+}
+
+// the levels of a capture from the analysis replace those of the meters
+void Dsp::work_response_static(uint32_t job, PluginLV2 *p)
+{
+	Dsp *self = static_cast<Dsp*>(p);
+	switch (JOB_KIND(job)) {
+	case JOB_FIR: self->fFir.work_response(JOB_SEQ(job)); break;
+	case JOB_FIT: self->fFit.work_response(JOB_SEQ(job)); break;
+	case JOB_SPEC:
+		if (self->fSpec.work_response(JOB_SEQ(job)) && self->fMatchWait) {
+			self->fSpecDone = self->fSpec.result(self->fSpecDb, self->fMatchDb);
+			self->fMatchDone = self->fMatchWait;
+			self->fMatchWait = 0;
+		}
+		break;
+	default: break;
+	}
 }
 
 /*
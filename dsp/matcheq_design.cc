@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2014 Guitarix project MOD project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * --------------------------------------------------------------------------
+ */
+
+// shared parts of the engines which redesign their filter on the LV2
+// worker thread when the band gains change (matcheq_fir.cc, matcheq_fit.cc),
+// BankResponse is also used by the analysis of matcheq_spec.cc
+
+namespace matcheq {
+
+////////////////////////// BANK RESPONSE ///////////////////////////////
+
+// transfer function of the crossover bank, the same splits as SimdBank
+class BankResponse {
+private:
+	double fC[BANK_STAGES];
+	double fN[BANK_STAGES];
+	double fD1[BANK_STAGES];
+	double fD2[BANK_STAGES];
+	double fA1[BANK_STAGES];
+
+public:
+	void init(double fs);
+	// g[] linear band gains, w in rad/sample
+	std::complex<double> at(const double *g, double w) const;
+	// squared magnitude of each band alone at w, band order of SimdBank
+	void bands(double w, double *mag2) const;
+};
+
+void BankResponse::init(double fs)
+{
+	for (int s = 0; s < BANK_STAGES; s++) {
+		const double c = 1.0 / bank_prewarp(s, fs);
+		fC[s] = c;
+		fN[s] = 1.0 / ((c + 1.0) * c + 1.0);
+		fD1[s] = fN[s] * 2.0 * (1.0 - c * c);
+		fD2[s] = fN[s] * ((c - 1.0) * c + 1.0);
+		fA1[s] = (1.0 - c) / (1.0 + c);
+	}
+}
+
+// summed the same way as SimdBank::compute_tree()
+std::complex<double> BankResponse::at(const double *g, double w) const
+{
+	typedef std::complex<double> cplx;
+	const cplx z1 = std::polar(1.0, -w);
+	const cplx z2 = z1 * z1;
+	cplx low = 1.0;
+	cplx sum = 0.0;
+	for (int s = 0; s < BANK_STAGES; s++) {
+		const double c = fC[s];
+		const cplx p1 = 1.0 / (1.0 + fA1[s] * z1);
+		const cplx p2 = 1.0 / (1.0 + fD1[s] * z1 + fD2[s] * z2);
+		const cplx hp = (c / (c + 1.0)) * (1.0 - z1) * p1 * fN[s] * c * c * (1.0 - 2.0 * z1 + z2) * p2;
+		const cplx lp = (1.0 / (c + 1.0)) * (1.0 + z1) * p1 * fN[s] * (1.0 + 2.0 * z1 + z2) * p2;
+		const cplx ap = (fD2[s] + fD1[s] * z1 + z2) * p2;
+		sum = sum * ap + g[s] * low * hp;
+		low *= lp;
+	}
+	return sum + g[BANK_STAGES] * low;
+}
+
+// the allpasses the higher bands go through don't change the magnitude
+void BankResponse::bands(double w, double *mag2) const
+{
+	typedef std::complex<double> cplx;
+	const cplx z1 = std::polar(1.0, -w);
+	const cplx z2 = z1 * z1;
+	cplx low = 1.0;
+	for (int s = 0; s < BANK_STAGES; s++) {
+		const double c = fC[s];
+		const cplx p1 = 1.0 / (1.0 + fA1[s] * z1);
+		const cplx p2 = 1.0 / (1.0 + fD1[s] * z1 + fD2[s] * z2);
+		const cplx hp = (c / (c + 1.0)) * (1.0 - z1) * p1 * fN[s] * c * c * (1.0 - 2.0 * z1 + z2) * p2;
+		const cplx lp = (1.0 / (c + 1.0)) * (1.0 + z1) * p1 * fN[s] * (1.0 + 2.0 * z1 + z2) * p2;
+		mag2[s] = std::norm(low * hp);
+		low *= lp;
+	}
+	mag2[BANK_STAGES] = std::norm(low);
+}
+
+////////////////////////// DESIGN REQUEST //////////////////////////////
+
+enum {
+	DESIGN_IDLE,    // filter matches fDesigned
+	DESIGN_REQUEST, // fRequest waits for the worker
+	DESIGN_BUSY,    // worker scheduled, swap in work_response()
+};
+
+// A job of the LV2 worker, the engine in the low byte and the sequence
+// number of its request above. Each request gets its own job, work() and
+// work_response() only touch the engine the job was scheduled for.
+enum {
+	JOB_NONE,
+	JOB_FIR,
+	JOB_FIT,
+	JOB_SPEC,
+};
+
+#define JOB_KIND(job) ((job) & 0xffu)
+#define JOB_SEQ(job) ((job) >> 8)
+#define JOB_SEQ_MASK 0xffffffu
+
+// One design at a time. The audio thread leaves fRequest and the spare
+// filter alone while the state is DESIGN_BUSY, the worker thread only
+// touches those. The release store of DESIGN_BUSY hands fRequest over,
+// a response only swaps in the design of the job it belongs to.
+class DesignRequest {
+protected:
+	double fRequest[BANK_BANDS];  // gains in dB, band order of SimdBank
+	double fDesigned[BANK_BANDS];
+	std::atomic<int> fState;
+	std::atomic<uint32_t> fSeq;   // sequence number of the last request
+
+	DesignRequest() : fState(DESIGN_IDLE), fSeq(0) {
+		for (int b = 0; b < BANK_BANDS; b++) {
+			fRequest[b] = 0.0;
+			fDesigned[b] = 0.0;
+		}
+	}
+	// audio thread: ask for a new design when the gains moved
+	void request(const double *gain) {
+		if (fState.load(std::memory_order_relaxed) != DESIGN_IDLE) return;
+		bool changed = false;
+		for (int b = 0; b < BANK_BANDS; b++) changed |= (gain[b] != fDesigned[b]);
+		if (!changed) return;
+		for (int b = 0; b < BANK_BANDS; b++) {
+			fDesigned[b] = gain[b];
+			fRequest[b] = gain[b];
+		}
+		fState.store(DESIGN_REQUEST, std::memory_order_relaxed);
+	}
+	// audio thread: forget a request, a job still on its way is stale
+	void reset() {
+		fState.store(DESIGN_IDLE, std::memory_order_release);
+	}
+	// worker thread: true when the job is the one the audio thread waits for
+	bool work_current(uint32_t seq) const {
+		return fState.load(std::memory_order_acquire) == DESIGN_BUSY &&
+		       fSeq.load(std::memory_order_relaxed) == seq;
+	}
+	// audio thread: true when the response belongs to the pending request
+	bool respond(uint32_t seq) {
+		if (fState.load(std::memory_order_relaxed) != DESIGN_BUSY ||
+		    fSeq.load(std::memory_order_relaxed) != seq) return false;
+		fState.store(DESIGN_IDLE, std::memory_order_release);
+		return true;
+	}
+
+public:
+	// audio thread: once per request the sequence number of the job the
+	// caller schedules, 0 for none
+	uint32_t work_pending() {
+		if (fState.load(std::memory_order_relaxed) != DESIGN_REQUEST) return 0;
+		uint32_t seq = (fSeq.load(std::memory_order_relaxed) + 1) & JOB_SEQ_MASK;
+		if (!seq) seq = 1;
+		fSeq.store(seq, std::memory_order_relaxed);
+		fState.store(DESIGN_BUSY, std::memory_order_release);
+		return seq;
+	}
+};
+
+} // end namespace matcheq
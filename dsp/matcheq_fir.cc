@@ -0,0 +1,418 @@
+/*
+ * Copyright (C) 2014 Guitarix project MOD project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * --------------------------------------------------------------------------
+ */
+
+// linear phase mode of matcheq.cc (engine 3)
+//
+// The magnitude response of the crossover bank at the current band gains
+// is sampled on the grid of a FIR_TAPS long FFT, turned into a zero phase
+// impulse, shifted by half its length and windowed. The result runs as
+// uniform partitioned convolution (overlap save, partitions of FIR_PART
+// samples, frequency domain delay line), so the cost per sample does not
+// grow with the length of the filter.
+//
+// The filter is designed by design() on the LV2 worker thread into the
+// kernel not in use. work_response() swaps the kernels on the audio thread
+// between two run() calls, and the next partition crossfades from the old
+// to the new kernel. Latency is FIR_TAPS / 2 + FIR_PART samples; the dry
+// part of MORPH is delayed by the same amount.
+
+namespace matcheq {
+
+// at 44.1/48 kHz, doubled for every octave of sample rate above
+#define FIR_TAPS 8192
+#define FIR_PART 256
+
+///////////////////////// REAL FFT ////////////////////////////////////
+
+// radix 2 FFT of real data of size n, by a complex FFT of size n/2
+class FirFFT {
+private:
+	typedef std::complex<double> cplx;
+	int fSize;
+	int *fRev;
+	cplx *fTwiddle; // e^(-2 pi i k / n), k < n/2
+	cplx *fWork;
+
+	void transform(cplx *x, bool inv);
+
+public:
+	FirFFT() : fSize(0), fRev(0), fTwiddle(0), fWork(0) {}
+	~FirFFT() { mem_free(); }
+	void mem_alloc(int n);
+	void mem_free();
+	// in[n] -> re[n/2+1], im[n/2+1]
+	void forward(const double *in, double *re, double *im);
+	// re[n/2+1], im[n/2+1] -> out[n], scaled by 1/n
+	void inverse(const double *re, const double *im, double *out);
+};
+
+void FirFFT::mem_alloc(int n)
+{
+	mem_free();
+	fSize = n;
+	const int m = n / 2;
+	fRev = mem_new<int>(m);
+	fTwiddle = mem_new<cplx>(m);
+	fWork = mem_new<cplx>(m);
+	int bits = 0;
+	while ((1 << bits) < m) bits++;
+	for (int k = 0; k < m; k++) {
+		int r = 0;
+		for (int b = 0; b < bits; b++) r |= ((k >> b) & 1) << (bits - 1 - b);
+		fRev[k] = r;
+	}
+	for (int k = 0; k < m; k++) fTwiddle[k] = std::polar(1.0, -2.0 * M_PI * k / n);
+}
+
+void FirFFT::mem_free()
+{
+	mem_put(fRev);
+	mem_put(fTwiddle);
+	mem_put(fWork);
+	fRev = 0;
+	fTwiddle = 0;
+	fWork = 0;
+	fSize = 0;
+}
+
+// in place complex FFT of size n/2, input in bit reversed order,
+// the twiddles of size n/2 are every second one of fTwiddle
+void FirFFT::transform(cplx *x, bool inv)
+{
+	const int m = fSize / 2;
+	for (int len = 2; len <= m; len <<= 1) {
+		const int h = len >> 1;
+		const int step = fSize / len;
+		for (int i = 0; i < m; i += len) {
+			for (int k = 0; k < h; k++) {
+				cplx w = fTwiddle[k * step];
+				if (inv) w = std::conj(w);
+				const cplx t = w * x[i + k + h];
+				x[i + k + h] = x[i + k] - t;
+				x[i + k] += t;
+			}
+		}
+	}
+}
+
+void FirFFT::forward(const double *in, double *re, double *im)
+{
+	const int m = fSize / 2;
+	for (int k = 0; k < m; k++) fWork[fRev[k]] = cplx(in[2 * k], in[2 * k + 1]);
+	transform(fWork, false);
+	// split into the transforms of the even and odd samples
+	for (int k = 0; k < m; k++) {
+		const cplx z = fWork[k];
+		const cplx zc = std::conj(fWork[(m - k) & (m - 1)]);
+		const cplx e = 0.5 * (z + zc);
+		const cplx o = cplx(0.0, -0.5) * (z - zc);
+		const cplx x = e + fTwiddle[k] * o;
+		re[k] = x.real();
+		im[k] = x.imag();
+	}
+	re[m] = fWork[0].real() - fWork[0].imag();
+	im[m] = 0.0;
+}
+
+void FirFFT::inverse(const double *re, const double *im, double *out)
+{
+	const int m = fSize / 2;
+	for (int k = 0; k < m; k++) {
+		const cplx x(re[k], im[k]);
+		const cplx xc(re[m - k], -im[m - k]);
+		const cplx e = 0.5 * (x + xc);
+		const cplx o = 0.5 * (x - xc) * std::conj(fTwiddle[k]);
+		fWork[fRev[k]] = e + cplx(0.0, 1.0) * o;
+	}
+	transform(fWork, true);
+	const double scale = 1.0 / m;
+	for (int k = 0; k < m; k++) {
+		out[2 * k] = fWork[k].real() * scale;
+		out[2 * k + 1] = fWork[k].imag() * scale;
+	}
+}
+
+///////////////////////// FIR CLASS ////////////////////////////////////
+
+class FirEq : public DesignRequest {
+private:
+	int fTaps;
+	int fPart;
+	int fParts;
+	int fDelay;
+	FirFFT fFFT;
+	FirFFT fPartFFT;   // fFFT for the worker
+	FirFFT fDesignFFT;
+	BankResponse fBank;
+	// audio thread
+	double *fIn;      // last two partitions of input
+	double *fOut;     // output of the last partition
+	double *fOld;     // output of the old kernel while crossfading
+	double *fTime;    // scratch, 2 * fPart
+	double *fAccRe;   // scratch, fPart + 1
+	double *fAccIm;
+	double *fFdlRe;   // input spectra, fParts * (fPart + 1)
+	double *fFdlIm;
+	double *fKernRe[2];
+	double *fKernIm[2];
+	float *fDry;
+	int fFdlPos;
+	int fPos;
+	int fDryPos;
+	int fActive;
+	bool fFade;
+	// worker thread
+	double *fDesign;  // fTaps
+	double *fPartTime; // 2 * fPart
+	double *fSpecRe;  // fTaps / 2 + 1
+	double *fSpecIm;
+	bool mem_allocated;
+
+	void process_part();
+	void convolve(int k, double *out);
+
+public:
+	FirEq();
+	~FirEq() { mem_free(); }
+	void init(double fs);
+	void mem_alloc();
+	void mem_free();
+	void clear_state();
+	void design(const double *gain);
+	void update(const double *gain);
+	void work(uint32_t seq);
+	void work_response(uint32_t seq);
+	void compute(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0, const BankParam& p);
+	inline bool ready() const { return mem_allocated; }
+	inline int latency() const { return fDelay; }
+};
+
+FirEq::FirEq()
+	: fTaps(0), fPart(0), fParts(0), fDelay(0),
+	  fIn(0), fOut(0), fOld(0), fTime(0), fAccRe(0), fAccIm(0),
+	  fFdlRe(0), fFdlIm(0), fDry(0), fActive(0), fDesign(0), fPartTime(0),
+	  fSpecRe(0), fSpecIm(0), mem_allocated(false) {
+	fKernRe[0] = fKernRe[1] = fKernIm[0] = fKernIm[1] = 0;
+}
+
+// FIR_TAPS and FIR_PART scale by this at fs
+static inline int fir_scale(double fs)
+{
+	int r = 1;
+	while (fs > 50000.0 * r) r *= 2;
+	return r;
+}
+
+void FirEq::init(double fs)
+{
+	const int r = fir_scale(fs);
+	fTaps = FIR_TAPS * r;
+	fPart = FIR_PART * r;
+	fParts = fTaps / fPart;
+	fDelay = fTaps / 2 + fPart;
+	fBank.init(fs);
+}
+
+void FirEq::mem_alloc()
+{
+	if (mem_allocated) return;
+	const int bins = fPart + 1;
+	fFFT.mem_alloc(2 * fPart);
+	fPartFFT.mem_alloc(2 * fPart);
+	fDesignFFT.mem_alloc(fTaps);
+	fIn = mem_new<double>(2 * fPart);
+	fOut = mem_new<double>(fPart);
+	fOld = mem_new<double>(fPart);
+	fTime = mem_new<double>(2 * fPart);
+	fAccRe = mem_new<double>(bins);
+	fAccIm = mem_new<double>(bins);
+	fFdlRe = mem_new<double>(fParts * bins);
+	fFdlIm = mem_new<double>(fParts * bins);
+	for (int k = 0; k < 2; k++) {
+		fKernRe[k] = mem_new<double>(fParts * bins);
+		fKernIm[k] = mem_new<double>(fParts * bins);
+	}
+	fDry = mem_new<float>(fDelay);
+	fDesign = mem_new<double>(fTaps);
+	fPartTime = mem_new<double>(2 * fPart);
+	fSpecRe = mem_new<double>(fTaps / 2 + 1);
+	fSpecIm = mem_new<double>(fTaps / 2 + 1);
+	mem_allocated = true;
+	// start out flat, the audio thread asks for the real gains
+	for (int b = 0; b < BANK_BANDS; b++) fDesigned[b] = 0.0;
+	design(fDesigned);
+	fActive ^= 1;
+	reset();
+	clear_state();
+}
+
+void FirEq::mem_free()
+{
+	if (!mem_allocated) return;
+	mem_allocated = false;
+	fFFT.mem_free();
+	fPartFFT.mem_free();
+	fDesignFFT.mem_free();
+	mem_put(fIn);
+	mem_put(fOut);
+	mem_put(fOld);
+	mem_put(fTime);
+	mem_put(fAccRe);
+	mem_put(fAccIm);
+	mem_put(fFdlRe);
+	mem_put(fFdlIm);
+	for (int k = 0; k < 2; k++) {
+		mem_put(fKernRe[k]);
+		mem_put(fKernIm[k]);
+	}
+	mem_put(fDry);
+	mem_put(fDesign);
+	mem_put(fPartTime);
+	mem_put(fSpecRe);
+	mem_put(fSpecIm);
+}
+
+void FirEq::clear_state()
+{
+	if (!mem_allocated) return;
+	const int bins = fPart + 1;
+	for (int i = 0; i < 2 * fPart; i++) fIn[i] = 0.0;
+	for (int i = 0; i < fPart; i++) fOut[i] = 0.0;
+	for (int i = 0; i < fParts * bins; i++) {
+		fFdlRe[i] = 0.0;
+		fFdlIm[i] = 0.0;
+	}
+	for (int i = 0; i < fDelay; i++) fDry[i] = 0.0f;
+	fFdlPos = 0;
+	fPos = 0;
+	fDryPos = 0;
+	fFade = false;
+}
+
+// gain[] in dB, band order as SimdBank. Writes the kernel not in use.
+void FirEq::design(const double *gain)
+{
+	const int m = fTaps / 2;
+	double g[BANK_BANDS];
+	for (int b = 0; b < BANK_BANDS; b++) g[b] = std::pow(10.0, 0.05 * gain[b]);
+	// magnitude of the bank
+	for (int k = 0; k <= m; k++) {
+		fSpecRe[k] = std::abs(fBank.at(g, M_PI * k / m));
+		fSpecIm[k] = 0.0;
+	}
+	// zero phase impulse, shifted by half the length and windowed, cut
+	// into the partitions of the kernel not in use
+	fDesignFFT.inverse(fSpecRe, fSpecIm, fDesign);
+	const int bins = fPart + 1;
+	const int spare = fActive ^ 1;
+	for (int p = 0; p < fParts; p++) {
+		for (int i = 0; i < fPart; i++) {
+			const int n = p * fPart + i;
+			const double w = 0.5 - 0.5 * std::cos(2.0 * M_PI * n / fTaps);
+			fPartTime[i] = fDesign[(n + m) & (fTaps - 1)] * w;
+			fPartTime[fPart + i] = 0.0;
+		}
+		fPartFFT.forward(fPartTime, fKernRe[spare] + p * bins, fKernIm[spare] + p * bins);
+	}
+}
+
+// audio thread: not before the crossfade to the last design is through
+void FirEq::update(const double *gain)
+{
+	if (!fFade) request(gain);
+}
+
+// worker thread
+void FirEq::work(uint32_t seq)
+{
+	if (mem_allocated && work_current(seq)) design(fRequest);
+}
+
+// audio thread, between two run() calls
+void FirEq::work_response(uint32_t seq)
+{
+	if (!respond(seq)) return;
+	fActive ^= 1;
+	fFade = true;
+}
+
+// y = IFFT(sum over the partitions of input spectrum * kernel k)
+void always_inline FirEq::convolve(int k, double *out)
+{
+	const int bins = fPart + 1;
+	for (int i = 0; i < bins; i++) {
+		fAccRe[i] = 0.0;
+		fAccIm[i] = 0.0;
+	}
+	int slot = fFdlPos;
+	for (int p = 0; p < fParts; p++) {
+		const double *xr = fFdlRe + slot * bins;
+		const double *xi = fFdlIm + slot * bins;
+		const double *hr = fKernRe[k] + p * bins;
+		const double *hi = fKernIm[k] + p * bins;
+		for (int i = 0; i < bins; i++) {
+			fAccRe[i] += xr[i] * hr[i] - xi[i] * hi[i];
+			fAccIm[i] += xr[i] * hi[i] + xi[i] * hr[i];
+		}
+		slot = slot ? slot - 1 : fParts - 1;
+	}
+	fFFT.inverse(fAccRe, fAccIm, fTime);
+	// overlap save, the second half is the linear convolution
+	for (int i = 0; i < fPart; i++) out[i] = fTime[fPart + i];
+}
+
+void always_inline FirEq::process_part()
+{
+	const int bins = fPart + 1;
+	fFdlPos = (fFdlPos + 1 < fParts) ? fFdlPos + 1 : 0;
+	fFFT.forward(fIn, fFdlRe + fFdlPos * bins, fFdlIm + fFdlPos * bins);
+	for (int i = 0; i < fPart; i++) fIn[i] = fIn[fPart + i];
+	convolve(fActive, fOut);
+	if (fFade) {
+		convolve(fActive ^ 1, fOld);
+		const double step = 1.0 / fPart;
+		for (int i = 0; i < fPart; i++) {
+			const double t = (i + 1) * step;
+			fOut[i] = fOld[i] + t * (fOut[i] - fOld[i]);
+		}
+		fFade = false;
+	}
+}
+
+// morph and input gain of p, the band gains are not used here
+void always_inline FirEq::compute(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0, const BankParam& p)
+{
+	for (int i = 0; i < count; i++) {
+		const double fMorph = p.morph + (i + 1) * p.mstep;
+		const double fInGain = p.ingain + (i + 1) * p.istep;
+		const double fTemp0 = double(input0[i]);
+		fIn[fPart + fPos] = fInGain * fTemp0;
+		const double fTemp1 = fOut[fPos];
+		const double fTemp2 = double(fDry[fDryPos]);
+		fDry[fDryPos] = FAUSTFLOAT(fTemp0);
+		fDryPos = (fDryPos + 1 < fDelay) ? fDryPos + 1 : 0;
+		output0[i] = FAUSTFLOAT((((1.0 - fMorph) * fTemp2) + (fMorph * fTemp1)));
+		if (++fPos == fPart) {
+			process_part();
+			fPos = 0;
+		}
+	}
+}
+
+} // end namespace matcheq
@@ -0,0 +1,384 @@
+/*
+ * Copyright (C) 2014 Guitarix project MOD project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * --------------------------------------------------------------------------
+ */
+
+// fitted mode of matcheq.cc (engine 4)
+//
+// Once the band gains are set the response of the crossover bank is fixed,
+// so it can as well be approximated by a few peaking and shelving biquads
+// (RBJ cookbook). design() runs on the LV2 worker thread: the magnitude of
+// the bank in dB on FIT_POINTS log spaced frequencies is the target, a new
+// section goes where the error is largest (a shelf at either end of the
+// grid, a peak elsewhere), then all sections and a broadband gain are
+// refined by Levenberg-Marquardt. That repeats until the error is below
+// FIT_TOL dB everywhere or FIT_SECTIONS are in use. The fit is minimum
+// phase, the bank is not, only the magnitude is matched.
+//
+// The new cascade is written into the spare slot, work_response() swaps
+// the slots and the output crossfades over FIT_FADE_MS while both
+// cascades run.
+
+namespace matcheq {
+
+#define FIT_SECTIONS 8
+#define FIT_POINTS 96
+#define FIT_TOL 0.5      // dB
+#define FIT_ITER 40      // Levenberg-Marquardt steps per added section
+#define FIT_FADE_MS 20.0 // crossfade to a new cascade
+
+enum {
+	FIT_PEAK,
+	FIT_LOWSHELF,
+	FIT_HIGHSHELF,
+};
+
+struct FitCascade {
+	int n;
+	double error; // largest deviation from the bank in dB
+	double b0[FIT_SECTIONS];
+	double b1[FIT_SECTIONS];
+	double b2[FIT_SECTIONS];
+	double a1[FIT_SECTIONS];
+	double a2[FIT_SECTIONS];
+	double z1[FIT_SECTIONS];
+	double z2[FIT_SECTIONS];
+	double gain;
+};
+
+class FitEq : public DesignRequest {
+private:
+	double fFs;
+	BankResponse fBank;
+	// audio thread
+	FitCascade fCascade[2];
+	int fActive;
+	int fFade; // samples left of the crossfade
+	int fFadeLen;
+	// worker thread
+	double fCos1[FIT_POINTS];
+	double fSin1[FIT_POINTS];
+	double fCos2[FIT_POINTS];
+	double fSin2[FIT_POINTS];
+	double fTarget[FIT_POINTS];
+	int fType[FIT_SECTIONS];
+
+	void coefs(int type, const double *x, double *c) const;
+	void section(int type, const double *x, double *db) const;
+	double refine(double *x, int n, double (*sec)[FIT_POINTS]);
+	void design(const double *gain);
+	double run(FitCascade& c, double x);
+
+public:
+	FitEq();
+	void init(double fs);
+	void clear_state();
+	void update(const double *gain);
+	void work(uint32_t seq);
+	void work_response(uint32_t seq);
+	void compute(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0, const BankParam& p);
+	inline int sections() const { return fCascade[fActive].n; }
+	inline double error() const { return fCascade[fActive].error; }
+};
+
+FitEq::FitEq()
+	: fFs(48000.0), fActive(0), fFade(0), fFadeLen(960) {
+	for (int k = 0; k < 2; k++) {
+		fCascade[k].n = 0;
+		fCascade[k].error = 0.0;
+		fCascade[k].gain = 1.0;
+	}
+}
+
+void FitEq::init(double fs)
+{
+	fFs = fs;
+	fFadeLen = std::max<int>(1, int(FIT_FADE_MS * 0.001 * fs + 0.5));
+	fBank.init(fs);
+	// 20 Hz to 20 kHz, or 0.45 fs
+	const double lo = std::log(20.0);
+	const double hi = std::log(std::min<double>(20000.0, 0.45 * fs));
+	for (int k = 0; k < FIT_POINTS; k++) {
+		const double w = 2.0 * M_PI * std::exp(lo + (hi - lo) * k / (FIT_POINTS - 1)) / fs;
+		fCos1[k] = std::cos(w);
+		fSin1[k] = std::sin(w);
+		fCos2[k] = std::cos(2.0 * w);
+		fSin2[k] = std::sin(2.0 * w);
+	}
+	for (int k = 0; k < 2; k++) fCascade[k].n = 0;
+	reset();
+	for (int b = 0; b < BANK_BANDS; b++) fDesigned[b] = 0.0;
+}
+
+void FitEq::clear_state()
+{
+	for (int k = 0; k < 2; k++) {
+		for (int s = 0; s < FIT_SECTIONS; s++) {
+			fCascade[k].z1[s] = 0.0;
+			fCascade[k].z2[s] = 0.0;
+		}
+	}
+	fFade = 0;
+}
+
+// x = (log2 f, gain in dB, log2 q) -> normalized b0, b1, b2, a1, a2
+void FitEq::coefs(int type, const double *x, double *c) const
+{
+	const double A = std::pow(10.0, x[1] / 40.0);
+	const double w0 = 2.0 * M_PI * std::exp2(x[0]) / fFs;
+	const double cw = std::cos(w0);
+	const double alpha = std::sin(w0) / (2.0 * std::exp2(x[2]));
+	double b0, b1, b2, a0, a1, a2;
+	if (type == FIT_PEAK) {
+		b0 = 1.0 + alpha * A;
+		b1 = -2.0 * cw;
+		b2 = 1.0 - alpha * A;
+		a0 = 1.0 + alpha / A;
+		a1 = -2.0 * cw;
+		a2 = 1.0 - alpha / A;
+	} else {
+		const double s = (type == FIT_LOWSHELF) ? 1.0 : -1.0;
+		const double r = 2.0 * std::sqrt(A) * alpha;
+		b0 = A * ((A + 1.0) - s * (A - 1.0) * cw + r);
+		b1 = s * 2.0 * A * ((A - 1.0) - s * (A + 1.0) * cw);
+		b2 = A * ((A + 1.0) - s * (A - 1.0) * cw - r);
+		a0 = (A + 1.0) + s * (A - 1.0) * cw + r;
+		a1 = -s * 2.0 * ((A - 1.0) + s * (A + 1.0) * cw);
+		a2 = (A + 1.0) + s * (A - 1.0) * cw - r;
+	}
+	c[0] = b0 / a0;
+	c[1] = b1 / a0;
+	c[2] = b2 / a0;
+	c[3] = a1 / a0;
+	c[4] = a2 / a0;
+}
+
+// magnitude of one section in dB on the grid
+void FitEq::section(int type, const double *x, double *db) const
+{
+	double c[5];
+	coefs(type, x, c);
+	for (int k = 0; k < FIT_POINTS; k++) {
+		const double br = c[0] + c[1] * fCos1[k] + c[2] * fCos2[k];
+		const double bi = c[1] * fSin1[k] + c[2] * fSin2[k];
+		const double ar = 1.0 + c[3] * fCos1[k] + c[4] * fCos2[k];
+		const double ai = c[3] * fSin1[k] + c[4] * fSin2[k];
+		db[k] = 10.0 * std::log10((br * br + bi * bi) / (ar * ar + ai * ai));
+	}
+}
+
+// Levenberg-Marquardt over n sections x[3 * i ..] and the broadband gain
+// x[3 * n], sec[i] holds the response of section i. Returns the largest
+// error in dB.
+double FitEq::refine(double *x, int n, double (*sec)[FIT_POINTS])
+{
+	const int np = 3 * n + 1;
+	const double fmax = std::log2(0.49 * fFs);
+	double model[FIT_POINTS];
+	double r[FIT_POINTS];
+	double J[3 * FIT_SECTIONS + 1][FIT_POINTS];
+	double M[3 * FIT_SECTIONS + 1][3 * FIT_SECTIONS + 2];
+	double trial[3 * FIT_SECTIONS + 1];
+	double tsec[FIT_POINTS];
+	double lambda = 1e-2;
+	for (int it = 0; it < FIT_ITER; it++) {
+		double cost = 0.0;
+		for (int k = 0; k < FIT_POINTS; k++) {
+			model[k] = x[3 * n];
+			for (int i = 0; i < n; i++) model[k] += sec[i][k];
+			r[k] = fTarget[k] - model[k];
+			cost += r[k] * r[k];
+		}
+		// jacobian by forward differences, section by section
+		for (int i = 0; i < n; i++) {
+			for (int j = 0; j < 3; j++) {
+				const double h = 1e-4;
+				double xi[3] = { x[3 * i], x[3 * i + 1], x[3 * i + 2] };
+				xi[j] += h;
+				section(fType[i], xi, tsec);
+				for (int k = 0; k < FIT_POINTS; k++) J[3 * i + j][k] = (tsec[k] - sec[i][k]) / h;
+			}
+		}
+		for (int k = 0; k < FIT_POINTS; k++) J[3 * n][k] = 1.0;
+		// normal equations, damped
+		for (int a = 0; a < np; a++) {
+			for (int b = 0; b <= a; b++) {
+				double v = 0.0;
+				for (int k = 0; k < FIT_POINTS; k++) v += J[a][k] * J[b][k];
+				M[a][b] = M[b][a] = v;
+			}
+			double v = 0.0;
+			for (int k = 0; k < FIT_POINTS; k++) v += J[a][k] * r[k];
+			M[a][np] = v;
+		}
+		for (int a = 0; a < np; a++) M[a][a] *= (1.0 + lambda);
+		// gauss elimination with partial pivoting
+		for (int a = 0; a < np; a++) {
+			int p = a;
+			for (int b = a + 1; b < np; b++) if (std::fabs(M[b][a]) > std::fabs(M[p][a])) p = b;
+			if (p != a) for (int b = 0; b <= np; b++) std::swap(M[a][b], M[p][b]);
+			if (std::fabs(M[a][a]) < 1e-300) M[a][a] = 1e-300;
+			for (int b = a + 1; b < np; b++) {
+				const double f = M[b][a] / M[a][a];
+				for (int c = a; c <= np; c++) M[b][c] -= f * M[a][c];
+			}
+		}
+		for (int a = np - 1; a >= 0; a--) {
+			double v = M[a][np];
+			for (int b = a + 1; b < np; b++) v -= M[a][b] * trial[b];
+			trial[a] = v / M[a][a];
+		}
+		for (int a = 0; a < np; a++) trial[a] += x[a];
+		for (int i = 0; i < n; i++) {
+			trial[3 * i] = std::min<double>(std::max<double>(trial[3 * i], 3.0), fmax);
+			trial[3 * i + 1] = std::min<double>(std::max<double>(trial[3 * i + 1], -40.0), 40.0);
+			trial[3 * i + 2] = std::min<double>(std::max<double>(trial[3 * i + 2], -3.0), 4.0);
+		}
+		// accept when better
+		double tcost = 0.0;
+		double tmp[FIT_SECTIONS][FIT_POINTS];
+		for (int i = 0; i < n; i++) section(fType[i], trial + 3 * i, tmp[i]);
+		for (int k = 0; k < FIT_POINTS; k++) {
+			double m = trial[3 * n];
+			for (int i = 0; i < n; i++) m += tmp[i][k];
+			tcost += (fTarget[k] - m) * (fTarget[k] - m);
+		}
+		if (tcost < cost) {
+			for (int a = 0; a < np; a++) x[a] = trial[a];
+			for (int i = 0; i < n; i++)
+				for (int k = 0; k < FIT_POINTS; k++) sec[i][k] = tmp[i][k];
+			lambda = std::max<double>(lambda * 0.3, 1e-9);
+		} else {
+			lambda *= 4.0;
+		}
+	}
+	double err = 0.0;
+	for (int k = 0; k < FIT_POINTS; k++) {
+		double m = x[3 * n];
+		for (int i = 0; i < n; i++) m += sec[i][k];
+		err = std::max<double>(err, std::fabs(fTarget[k] - m));
+	}
+	return err;
+}
+
+// gain[] in dB, band order as SimdBank. Writes the cascade not in use.
+void FitEq::design(const double *gain)
+{
+	double g[BANK_BANDS];
+	for (int b = 0; b < BANK_BANDS; b++) g[b] = std::pow(10.0, 0.05 * gain[b]);
+	for (int k = 0; k < FIT_POINTS; k++) {
+		const double w = std::atan2(fSin1[k], fCos1[k]);
+		fTarget[k] = 20.0 * std::log10(std::abs(fBank.at(g, w)) + 1e-12);
+	}
+	double x[3 * FIT_SECTIONS + 1];
+	double sec[FIT_SECTIONS][FIT_POINTS];
+	int n = 0;
+	x[0] = 0.0;
+	double err = refine(x, 0, sec);
+	while (err > FIT_TOL && n < FIT_SECTIONS) {
+		// the broadband gain moves behind the new section
+		double gb = x[3 * n];
+		int kmax = 0;
+		double emax = 0.0;
+		for (int k = 0; k < FIT_POINTS; k++) {
+			double m = gb;
+			for (int i = 0; i < n; i++) m += sec[i][k];
+			if (std::fabs(fTarget[k] - m) > std::fabs(emax)) {
+				emax = fTarget[k] - m;
+				kmax = k;
+			}
+		}
+		const double w = std::atan2(fSin1[kmax], fCos1[kmax]);
+		fType[n] = (kmax == 0) ? FIT_LOWSHELF : (kmax == FIT_POINTS - 1) ? FIT_HIGHSHELF : FIT_PEAK;
+		x[3 * n] = std::log2(w * fFs / (2.0 * M_PI));
+		x[3 * n + 1] = emax;
+		x[3 * n + 2] = (fType[n] == FIT_PEAK) ? 0.0 : -0.5;
+		x[3 * n + 3] = gb;
+		section(fType[n], x + 3 * n, sec[n]);
+		n++;
+		err = refine(x, n, sec);
+	}
+	FitCascade& c = fCascade[fActive ^ 1];
+	for (int i = 0; i < n; i++) {
+		double k[5];
+		coefs(fType[i], x + 3 * i, k);
+		c.b0[i] = k[0];
+		c.b1[i] = k[1];
+		c.b2[i] = k[2];
+		c.a1[i] = k[3];
+		c.a2[i] = k[4];
+		c.z1[i] = 0.0;
+		c.z2[i] = 0.0;
+	}
+	c.n = n;
+	c.gain = std::pow(10.0, 0.05 * x[3 * n]);
+	c.error = err;
+}
+
+// audio thread: not before the crossfade to the last design is through
+void FitEq::update(const double *gain)
+{
+	if (!fFade) request(gain);
+}
+
+// worker thread
+void FitEq::work(uint32_t seq)
+{
+	if (work_current(seq)) design(fRequest);
+}
+
+// audio thread, between two run() calls
+void FitEq::work_response(uint32_t seq)
+{
+	if (!respond(seq)) return;
+	fActive ^= 1;
+	fFade = fFadeLen;
+}
+
+// one sample through a cascade, transposed direct form II
+double always_inline FitEq::run(FitCascade& c, double x)
+{
+	double y = c.gain * x;
+	for (int s = 0; s < c.n; s++) {
+		const double in = y;
+		y = c.b0[s] * in + c.z1[s];
+		c.z1[s] = c.b1[s] * in - c.a1[s] * y + c.z2[s];
+		c.z2[s] = c.b2[s] * in - c.a2[s] * y;
+	}
+	return y;
+}
+
+// morph and input gain of p, the band gains are not used here
+void always_inline FitEq::compute(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0, const BankParam& p)
+{
+	FitCascade& c = fCascade[fActive];
+	FitCascade& o = fCascade[fActive ^ 1];
+	for (int i = 0; i < count; i++) {
+		const double fMorph = p.morph + (i + 1) * p.mstep;
+		const double fInGain = p.ingain + (i + 1) * p.istep;
+		const double fTemp0 = double(input0[i]);
+		double fTemp1 = run(c, fInGain * fTemp0);
+		if (fFade) {
+			const double t = double(fFade) / fFadeLen;
+			fTemp1 += t * (run(o, fInGain * fTemp0) - fTemp1);
+			fFade--;
+		}
+		output0[i] = FAUSTFLOAT((((1.0 - fMorph) * fTemp0) + (fMorph * fTemp1)));
+	}
+}
+
+} // end namespace matcheq
@@ -0,0 +1,1547 @@
+/*
+ * Copyright (C) 2014 Guitarix project MOD project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * --------------------------------------------------------------------------
+ */
+
+// hand written SIMD kernel for the filterbank of matcheq.cc
+//
+// The crossover is a cascade of ten 3rd order butterworth splits. At split
+// s the lowpass branch, the highpass branch and the allpass phase
+// compensation of all bands split off before share the same poles, and
+// within one sample they don't depend on each other. So they are packed
+// into the lanes of a vector and run together:
+//
+//   lane 0 .. s-1   allpass for band 0 .. s-1
+//   lane s          highpass, becomes band s
+//   lane s+1        lowpass, feeds split s+1
+//
+// After the last split lane j carries band j, lane 10 the lowest band, which
+// is the order matcheq.cc uses for fVbargraph0 .. fVbargraph10.
+// Every lane runs a first order section followed by a biquad, both in
+// direct form II like the generated code. Allpass lanes get a unity first
+// order section.
+//
+// Tolerance against the generated code (engine 0), 44.1 kHz to 192 kHz:
+// the impulse response differs by less than 1e-13, noise at -6 dBFS by
+// less than 1e-8 absolute, the band meters by less than 1e-4 dB. Only the
+// order of the additions differs.
+
+namespace matcheq {
+
+#ifdef MATCHEQ_FLOAT
+
+// Splits which run in single precision are those with a crossover above
+// BANK_FLOAT_MIN * fs / pi, below it the poles come too close to the unit
+// circle for float and the splits stay in double.
+#ifndef BANK_FLOAT_MIN
+#define BANK_FLOAT_MIN 0.04
+#endif
+
+// the block kernel is double only
+#define BANK_BLOCK_MODE 0
+
+#else
+
+#define BANK_BLOCK_MODE (BankVec::W >= 4)
+
+#endif // MATCHEQ_FLOAT
+
+////////////////////////////// BANK CLASS //////////////////////////////
+
+#define BANK_STAGES 10
+#define BANK_BANDS 11
+#define BANK_LANES 16    // padded to a multiple of the widest vector (8 floats)
+#define BANK_SECTIONS 65 // lanes in use summed over all splits
+#define BANK_BLOCK 4     // samples per state space update
+#define BANK_CHUNK 64    // samples per pass through the splits in block mode
+
+// multirate tree, see compute_multirate()
+#define MR_RATE 8000.0       // lowest sample rate of the decimated path
+#define MR_DEC_MAX 16        // decimation at 192 kHz
+#define MR_PHASE 8           // taps per polyphase branch
+#define MR_TAPS (MR_DEC_MAX * MR_PHASE)
+#define MR_DELAY 128         // power of two above the latency
+#define MR_EDGE (1.0 / 32.0) // top crossover feeding the decimator, over its rate
+#define MR_BETA 8.6          // kaiser window, about 90 dB stopband
+
+// crossover frequencies as used by the generated code: tan(xover / fs)
+static constexpr double bank_xover[BANK_STAGES] = {
+	56894.242956511152, 35763.890768466204, 17771.989641357461,
+	8884.4240243519343, 4442.2120121759672, 2221.1060060879836,
+	1112.1237993707869, 556.06189968539343, 276.46015351590177,
+	138.23007675795088
+};
+
+// The usual sample rates take tan(xover / fs) from tables the compiler
+// fills in, see bank_prewarp(). The series run in long double, so their
+// sum rounds to the same double as std::tan() but for the odd last bit.
+#define BANK_RATES 5
+static constexpr double bank_rates[BANK_RATES] = {
+	44100.0, 48000.0, 88200.0, 96000.0, 192000.0
+};
+
+// term is the n-th of the series, next = term * -x2 / ((k + 1) * (k + 2))
+static constexpr long double bank_series(long double x2, long double term, int k)
+{
+	return k > 60 ? 0.0L : term + bank_series(x2, -term * x2 / ((k + 1) * (k + 2)), k + 2);
+}
+
+static constexpr double bank_ctan(double x)
+{
+	return double(bank_series((long double)x * x, x, 1) / bank_series((long double)x * x, 1.0L, 0));
+}
+
+#define BANK_TAN_ROW(fs) { \
+	bank_ctan(bank_xover[0] / fs), bank_ctan(bank_xover[1] / fs), \
+	bank_ctan(bank_xover[2] / fs), bank_ctan(bank_xover[3] / fs), \
+	bank_ctan(bank_xover[4] / fs), bank_ctan(bank_xover[5] / fs), \
+	bank_ctan(bank_xover[6] / fs), bank_ctan(bank_xover[7] / fs), \
+	bank_ctan(bank_xover[8] / fs), bank_ctan(bank_xover[9] / fs) }
+
+static constexpr double bank_tan[BANK_RATES][BANK_STAGES] = {
+	BANK_TAN_ROW(44100.0), BANK_TAN_ROW(48000.0), BANK_TAN_ROW(88200.0),
+	BANK_TAN_ROW(96000.0), BANK_TAN_ROW(192000.0)
+};
+
+// index into bank_rates[], -1 for any other rate
+static inline int bank_rate(double fs)
+{
+	for (int r = 0; r < BANK_RATES; r++) {
+		if (fs == bank_rates[r]) return r;
+	}
+	return -1;
+}
+
+// tan(bank_xover[s] / fs)
+static inline double bank_prewarp(int s, double fs)
+{
+	const int r = bank_rate(fs);
+	return r < 0 ? std::tan(bank_xover[s] / fs) : bank_tan[r][s];
+}
+
+// coefficients of a split, lane by lane. They only depend on the sample
+// rate and are shared, see BankConst.
+template <class T, int N = BANK_LANES>
+struct BankStageT {
+	// lane mask for the input of the lowpass branch
+	T lp[N] __attribute__((aligned(32)));
+	// first order section
+	T b0[N] __attribute__((aligned(32)));
+	T b1[N] __attribute__((aligned(32)));
+	T a1[N] __attribute__((aligned(32)));
+	// biquad
+	T c0[N] __attribute__((aligned(32)));
+	T c1[N] __attribute__((aligned(32)));
+	T c2[N] __attribute__((aligned(32)));
+	T d1[N] __attribute__((aligned(32)));
+	T d2[N] __attribute__((aligned(32)));
+};
+
+// state of a split, z1 of the first order section, q1 and q2 of the biquad
+template <class T, int N = BANK_LANES>
+struct BankStateT {
+	T z1[N] __attribute__((aligned(32)));
+	T q1[N] __attribute__((aligned(32)));
+	T q2[N] __attribute__((aligned(32)));
+};
+
+typedef BankStageT<double> BankStage;
+typedef BankStateT<double> BankState;
+
+// lanes of a split in the tree topology, see compute_tree()
+#define TREE_LANES 4 // allpass on the sum, highpass, lowpass, unused
+typedef BankStageT<double, TREE_LANES> TreeStage;
+typedef BankStateT<double, TREE_LANES> TreeState;
+
+// state of one section of the tree for N channels or instances, see
+// compute_channels() and BankBatch
+template <int N>
+struct ChannelSectionT {
+	double z1[N] __attribute__((aligned(32)));
+	double q1[N] __attribute__((aligned(32)));
+	double q2[N] __attribute__((aligned(32)));
+};
+
+typedef ChannelSectionT<BANK_CHANNELS> ChannelSection;
+
+// run split s for one sample, low is the lowpass output of the previous
+// split, returns the lowpass output of this one
+template <class V>
+static always_inline typename V::T bank_split(const BankStageT<typename V::T>& k,
+                                              BankStateT<typename V::T>& st,
+                                              typename V::T *buf, typename V::T low, int s)
+{
+	typedef typename V::v vec;
+	// merged in by mask to avoid a scalar store before the vector loads
+	const vec vlow = V::set1(low);
+	for (int l = 0; l <= s + 1; l += V::W) {
+		vec x = V::blend(V::load(buf + l), vlow, V::load(k.lp + l));
+		vec z1 = V::load(st.z1 + l);
+		vec w = V::sub(x, V::mul(V::load(k.a1 + l), z1));
+		vec y = V::add(V::mul(V::load(k.b0 + l), w), V::mul(V::load(k.b1 + l), z1));
+		V::store(st.z1 + l, w);
+		vec q1 = V::load(st.q1 + l);
+		vec q2 = V::load(st.q2 + l);
+		vec u = V::sub(V::sub(y, V::mul(V::load(k.d1 + l), q1)),
+		               V::mul(V::load(k.d2 + l), q2));
+		vec o = V::add(V::add(V::mul(V::load(k.c0 + l), u),
+		                      V::mul(V::load(k.c1 + l), q1)),
+		               V::mul(V::load(k.c2 + l), q2));
+		V::store(st.q2 + l, q1);
+		V::store(st.q1 + l, u);
+		V::store(buf + l, o);
+	}
+	return buf[s + 1];
+}
+
+// run split s of the tree topology for one sample, buf[0] gets the
+// allpassed sum, buf[1] the highpass and buf[2] the lowpass output
+template <class V>
+static always_inline void tree_split(const TreeStage& k, TreeState& st, double *buf,
+                                     double sum, double low)
+{
+	typedef typename V::v vec;
+	const vec vsum = V::set1(sum);
+	const vec vlow = V::set1(low);
+	for (int l = 0; l < 3; l += V::W) {
+		vec x = V::blend(vsum, vlow, V::load(k.lp + l));
+		vec z1 = V::load(st.z1 + l);
+		vec w = V::sub(x, V::mul(V::load(k.a1 + l), z1));
+		vec y = V::add(V::mul(V::load(k.b0 + l), w), V::mul(V::load(k.b1 + l), z1));
+		V::store(st.z1 + l, w);
+		vec q1 = V::load(st.q1 + l);
+		vec q2 = V::load(st.q2 + l);
+		vec u = V::sub(V::sub(y, V::mul(V::load(k.d1 + l), q1)),
+		               V::mul(V::load(k.d2 + l), q2));
+		vec o = V::add(V::add(V::mul(V::load(k.c0 + l), u),
+		                      V::mul(V::load(k.c1 + l), q1)),
+		               V::mul(V::load(k.c2 + l), q2));
+		V::store(st.q2 + l, q1);
+		V::store(st.q1 + l, u);
+		V::store(buf + l, o);
+	}
+}
+
+// run lane l of a tree split on the channels c .. c + W - 1 for one
+// sample, the coefficients are the same for all channels
+template <class V, class S>
+static always_inline typename V::v tree_section(const TreeStage& st, int l, S& z,
+                                                int c, typename V::v x)
+{
+	typedef typename V::v vec;
+	vec z1 = V::load(z.z1 + c);
+	vec w = V::sub(x, V::mul(V::set1(st.a1[l]), z1));
+	vec y = V::add(V::mul(V::set1(st.b0[l]), w), V::mul(V::set1(st.b1[l]), z1));
+	V::store(z.z1 + c, w);
+	vec q1 = V::load(z.q1 + c);
+	vec q2 = V::load(z.q2 + c);
+	vec u = V::sub(V::sub(y, V::mul(V::set1(st.d1[l]), q1)),
+	               V::mul(V::set1(st.d2[l]), q2));
+	vec o = V::add(V::add(V::mul(V::set1(st.c0[l]), u),
+	                      V::mul(V::set1(st.c1[l]), q1)),
+	               V::mul(V::set1(st.c2[l]), q2));
+	V::store(z.q2 + c, q1);
+	V::store(z.q1 + c, u);
+	return o;
+}
+
+// One lane of a split as state space system over BANK_BLOCK samples.
+// The state is (z1, q1, q2) of the direct form in BankState, so both
+// kernels can take over from each other at any sample.
+//
+//   y[k]  = sum_i o[i][k] * s[i] + sum_j h[j][k] * x[j]
+//   s'[i] = sum_k a[k][i] * s[k] + sum_j g[j][i] * x[j]
+struct BankBlock {
+	double h[BANK_BLOCK][BANK_BLOCK] __attribute__((aligned(32)));
+	double o[3][BANK_BLOCK] __attribute__((aligned(32)));
+	double g[BANK_BLOCK][4] __attribute__((aligned(32)));
+	double a[3][4] __attribute__((aligned(32)));
+};
+
+///////////////////////// BAND METERS ////////////////////////////////
+
+// The band meters read windows of fWindow samples. METER_PEAK holds the
+// largest magnitude of the last window, METER_RMS its root mean square.
+// With METER_OFF the kernels are built without the detector and the
+// readings stay where they are. METER_MATCH is METER_PEAK which adds the
+// energy of the bands to fEnergy as well, for the match captures.
+enum { METER_OFF, METER_PEAK, METER_RMS, METER_MATCH, METER_MODES };
+
+// what sample y adds to the envelope
+template <int M, class V>
+static always_inline typename V::v meter_in(typename V::v y, typename V::v vfloor)
+{
+	return (M == METER_RMS) ? V::mul(y, y) : V::vmax(vfloor, V::vabs(y));
+}
+
+template <int M, class V>
+static always_inline typename V::v meter_add(typename V::v env, typename V::v a)
+{
+	return (M == METER_RMS) ? V::add(env, a) : V::vmax(env, a);
+}
+
+// reading of a window, scale is 1 / window
+template <int M>
+static always_inline double meter_read(double env, double scale, double floor)
+{
+	return (M == METER_RMS) ? std::max<double>(floor, std::sqrt(env * scale)) : env;
+}
+
+// end of a window in lanes l .. l + W of env and hold
+template <int M, class V>
+static always_inline void meter_hold(double *hold, double *env, double scale, double floor)
+{
+	if (M == METER_RMS) {
+		for (int w = 0; w < V::W; w++) hold[w] = meter_read<M>(env[w], scale, floor);
+	} else {
+		V::store(hold, V::load(env));
+	}
+}
+
+// a kernel of SimdBank for the ramp and meter mode in use
+#define BANK_KERNEL(kernel, ...) do { \
+	switch (fMode + (p.ramp ? METER_MODES : 0)) { \
+	case METER_OFF: kernel<false, METER_OFF>(__VA_ARGS__); break; \
+	case METER_PEAK: kernel<false, METER_PEAK>(__VA_ARGS__); break; \
+	case METER_RMS: kernel<false, METER_RMS>(__VA_ARGS__); break; \
+	case METER_MATCH: kernel<false, METER_MATCH>(__VA_ARGS__); break; \
+	case METER_MODES + METER_OFF: kernel<true, METER_OFF>(__VA_ARGS__); break; \
+	case METER_MODES + METER_PEAK: kernel<true, METER_PEAK>(__VA_ARGS__); break; \
+	case METER_MODES + METER_RMS: kernel<true, METER_RMS>(__VA_ARGS__); break; \
+	default: kernel<true, METER_MATCH>(__VA_ARGS__); break; \
+	} } while (0)
+
+///////////////////////// PARAMETER RAMPS ////////////////////////////
+
+#define RAMP_MS 20.0 // length of the parameter ramps
+#define RAMP_PARAMS (BANK_BANDS + 2)
+#define RAMP_MORPH BANK_BANDS
+#define RAMP_INGAIN (BANK_BANDS + 1)
+
+// Band gains (linear), morph and input gain (linear) for a stretch of
+// samples. Sample i of it sees value + (i + 1) * step. Without a ramp
+// running all steps are zero and the kernels take the values as constants.
+struct BankParam {
+	double gain[BANK_LANES] __attribute__((aligned(32)));
+	double gstep[BANK_LANES] __attribute__((aligned(32)));
+	double morph;
+	double mstep;
+	double ingain;
+	double istep;
+	bool ramp;
+};
+
+// all band gains the same over the stretch, see SimdBank::compute_flat()
+static inline bool bank_flat(const BankParam& p)
+{
+	for (int s = 1; s < BANK_BANDS; s++) {
+		if (p.gain[s] != p.gain[0] || p.gstep[s] != p.gstep[0]) return false;
+	}
+	return true;
+}
+
+// Replaces the one pole smoothers of the generated code for the hand
+// written engines. The port values are compared once per block, pow()
+// only runs for a port which moved, and then all parameters ramp linearly
+// from where they are to their targets over RAMP_MS.
+class BankRamp {
+private:
+	double fValue[RAMP_PARAMS];
+	double fTarget[RAMP_PARAMS];
+	double fStep[RAMP_PARAMS];
+	float fPort[RAMP_PARAMS];   // port values of fTarget
+	int fLength;
+	int fLeft;                  // samples left of the running ramp
+	bool fValid;                // fPort is set
+	bool fMoved;
+
+public:
+	BankRamp() : fLength(1), fLeft(0), fValid(false), fMoved(false) {
+		for (int k = 0; k < RAMP_PARAMS; k++) {
+			fValue[k] = 0.0;
+			fTarget[k] = 0.0;
+			fStep[k] = 0.0;
+			fPort[k] = 0.0f;
+		}
+	}
+	void init(double fs) { fLength = std::max<int>(1, int(RAMP_MS * 0.001 * fs + 0.5)); }
+	// everything ramps up from zero again, like the smoothers after a clear
+	void clear() {
+		for (int k = 0; k < RAMP_PARAMS; k++) fValue[k] = 0.0;
+		fLeft = 0;
+		fValid = false;
+	}
+	inline void set(int k, FAUSTFLOAT port, bool db) {
+		if (fValid && port == fPort[k]) return;
+		fPort[k] = port;
+		fTarget[k] = db ? std::pow(10.0, (0.050000000000000003 * double(port))) : double(port);
+		fMoved = true;
+	}
+	inline double target(int k) const { return fTarget[k]; }
+	// length of the next stretch of at most count samples, a ramp which
+	// ends within count ends the stretch
+	int stretch(int count);
+	// parameters for the next stretch, returns its length
+	int next(int count, BankParam& p);
+};
+
+int BankRamp::stretch(int count)
+{
+	if (fMoved || !fValid) {
+		for (int k = 0; k < RAMP_PARAMS; k++) fStep[k] = (fTarget[k] - fValue[k]) / fLength;
+		fLeft = fLength;
+		fMoved = false;
+		fValid = true;
+	}
+	return fLeft ? std::min<int>(count, fLeft) : count;
+}
+
+int BankRamp::next(int count, BankParam& p)
+{
+	const int n = stretch(count);
+	p.ramp = (fLeft > 0);
+	for (int l = 0; l < BANK_LANES; l++) {
+		p.gain[l] = (l < BANK_BANDS) ? fValue[l] : 0.0;
+		p.gstep[l] = (l < BANK_BANDS && p.ramp) ? fStep[l] : 0.0;
+	}
+	p.morph = fValue[RAMP_MORPH];
+	p.mstep = p.ramp ? fStep[RAMP_MORPH] : 0.0;
+	p.ingain = fValue[RAMP_INGAIN];
+	p.istep = p.ramp ? fStep[RAMP_INGAIN] : 0.0;
+	if (fLeft) {
+		fLeft -= n;
+		for (int k = 0; k < RAMP_PARAMS; k++) {
+			fValue[k] = fLeft ? fValue[k] + n * fStep[k] : fTarget[k];
+		}
+	}
+	return n;
+}
+
+// The coefficients of the bank at one sample rate. They don't change
+// after bank_const(), so all instances at the rate share one set, see
+// ref_acquire() in matcheq.cc, and SimdBank only keeps the state.
+struct BankConst {
+	BankStage stage[BANK_STAGES];
+	BankBlock block[BANK_SECTIONS]; // the lanes of stage, see bank_block()
+	TreeStage tree[BANK_STAGES];
+	// multirate tree: splits decSplit .. 9 run at fs / dec
+	TreeStage treeLow[BANK_STAGES];
+	double decCoef[MR_TAPS] __attribute__((aligned(32)));
+	double intCoef[MR_DEC_MAX][MR_PHASE] __attribute__((aligned(32)));
+	int dec;
+	int decSplit;
+	// cascade of the split allpasses, see compute_flat()
+	double flat[BANK_STAGES][2]; // d1, d2
+	double index[BANK_CHUNK] __attribute__((aligned(32))); // i + 1, see BankParam
+#ifdef MATCHEQ_FLOAT
+	BankStageT<float> stageF[BANK_STAGES];
+	int split; // splits running in float
+#endif
+};
+
+class SimdBank {
+private:
+	// hot, what compute() and compute_tree() touch per sample, in that
+	// order: the scalars, the meters and the state of the splits
+	const BankConst *fConst;
+	int fCount;
+	int fWindow;      // meter window in samples
+	int fMode;        // METER_OFF .. METER_RMS
+	double fScale;    // 1 / fWindow
+	double fFloor;
+	double fBuf[BANK_LANES] __attribute__((aligned(64)));
+	double fEnv[BANK_LANES] __attribute__((aligned(32)));
+	TreeState fTree[BANK_STAGES];
+	BankState fStage[BANK_STAGES];
+#ifdef MATCHEQ_FLOAT
+	BankStateT<float> fStageF[BANK_STAGES];
+	float fBufF[BANK_LANES] __attribute__((aligned(32)));
+#endif
+	// once per meter window, or only while matching
+	double fHold[BANK_LANES] __attribute__((aligned(32)));
+	double fEnergy[BANK_LANES] __attribute__((aligned(32)));  // METER_MATCH
+	// cold, the block kernel, the multirate tree, the channels and the
+	// flat path, which the mono kernels above never touch
+	double fChunk[BANK_BANDS + 1][BANK_CHUNK] __attribute__((aligned(64)));
+	double fMeter[BANK_CHUNK] __attribute__((aligned(32)));
+	// multirate tree, see BankConst
+	TreeState fTreeLow[BANK_STAGES];
+	double fApState[BANK_STAGES][3]; // z1, q1, q2 of the allpasses on the sum
+	double fDecHist[2 * MR_TAPS] __attribute__((aligned(32)));
+	double fIntHist[2 * MR_PHASE] __attribute__((aligned(32)));
+	double fDelayDry[MR_DELAY];
+	double fDelaySum[MR_DELAY];
+	int fDecPos;
+	int fIntPos;
+	int fDelayPos;
+	int fPhase;       // samples since the last decimated one
+	bool fDecReset;   // meter reset pending for the decimated bands
+	// tree with the channels in the lanes
+	ChannelSection fChTree[BANK_STAGES][3];
+	double fChEnv[BANK_BANDS][BANK_CHANNELS] __attribute__((aligned(32)));
+	double fChHold[BANK_BANDS][BANK_CHANNELS] __attribute__((aligned(32)));
+	double fChEnergy[BANK_BANDS][BANK_CHANNELS] __attribute__((aligned(32)));
+	double fFlatQ[BANK_STAGES][2]; // see compute_flat()
+
+	template <int M>
+	inline double meter(int s, double y, bool reset, double weight = 1.0);
+	template <bool RAMP, int M>
+	void compute_bank(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0,
+	                  const BankParam& p, int offset);
+	template <bool RAMP, int M>
+	void compute_chunk(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0,
+	                   const BankParam& p, int offset);
+	template <bool RAMP, int M>
+	void compute_tree_t(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0,
+	                    const BankParam& p);
+	template <bool RAMP, int M>
+	void compute_decimated(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0,
+	                       const BankParam& p, int offset);
+	template <bool RAMP, int M>
+	void compute_channels_t(int count, int channels, FAUSTFLOAT **inputs, FAUSTFLOAT **outputs,
+	                        const BankParam& p, int analysis);
+
+public:
+	SimdBank() : fConst(0) {}
+	// k stays with the caller for the life of the bank
+	void init(const BankConst *k, double fs);
+	void clear_state();
+	void clear_sections();
+	void clear_flat();
+	void compute(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0, const BankParam& p);
+	void compute_block(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0, const BankParam& p);
+	void compute_tree(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0, const BankParam& p);
+	void compute_multirate(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0, const BankParam& p);
+	void compute_channels(int count, int channels, FAUSTFLOAT **inputs, FAUSTFLOAT **outputs,
+	                      const BankParam& p, int analysis);
+	void compute_flat(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0,
+	                  const BankParam& p, bool through);
+	// engine 5 needs a decimation of at least 2
+	inline bool multirate() const { return fConst->dec > 1; }
+	inline int latency() const { return fConst->dec * MR_PHASE - 1; }
+	inline double power(int band) const { return fHold[band]; }
+	inline void set_power(int band, double h) { fHold[band] = h; }
+	inline const TreeStage *tree() const { return fConst->tree; }
+	inline double floor() const { return fFloor; }
+	inline int window() const { return fWindow; }
+	// sum of the squares of band since clear_energy()
+	inline double energy(int band) const { return fEnergy[band]; }
+	inline void add_energy(int band, double e) { fEnergy[band] += e; }
+	inline void clear_energy() {
+		for (int l = 0; l < BANK_LANES; l++) fEnergy[l] = 0.0;
+		for (int l = 0; l < BANK_BANDS; l++) {
+			for (int c = 0; c < BANK_CHANNELS; c++) fChEnergy[l][c] = 0.0;
+		}
+	}
+	// mode and window of the meters from the next sample on, a new mode
+	// starts from the floor
+	inline void set_meter(int mode, int window) {
+		if (mode != fMode) clear_power();
+		fMode = mode;
+		fWindow = window;
+		fScale = 1.0 / window;
+	}
+	// meters at the floor, for when the bank doesn't run
+	inline void clear_power() {
+		for (int l = 0; l < BANK_LANES; l++) {
+			fEnv[l] = fFloor;
+			fHold[l] = fFloor;
+		}
+	}
+};
+
+// tree topology: lane 0 is the allpass on the running sum (bank lane s-1,
+// unused at the first split where the sum is still zero), lane 1 the
+// highpass (bank lane s), lane 2 the lowpass (bank lane s+1).
+// t is the prewarped crossover, tan(xover / fs).
+static void tree_init(TreeStage& tr, int s, double t)
+{
+	const uint64_t ones = ~uint64_t(0);
+	const double c = 1.0 / t;
+	const double n = 1.0 / ((c + 1.0) * c + 1.0);
+	const double d1 = n * 2.0 * (1.0 - c * c);
+	const double d2 = n * ((c - 1.0) * c + 1.0);
+	for (int l = 0; l < TREE_LANES; l++) {
+		tr.b0[l] = 0.0; tr.b1[l] = 0.0; tr.a1[l] = 0.0;
+		tr.c0[l] = 0.0; tr.c1[l] = 0.0; tr.c2[l] = 0.0;
+		tr.d1[l] = 0.0; tr.d2[l] = 0.0;
+		if (l == 1 || l == 2)
+			memcpy(&tr.lp[l], &ones, sizeof(ones));
+		else
+			tr.lp[l] = 0.0;
+	}
+	if (s > 0) { // allpass
+		tr.b0[0] = 1.0;
+		tr.c0[0] = d2; tr.c1[0] = d1; tr.c2[0] = 1.0;
+		tr.d1[0] = d1; tr.d2[0] = d2;
+	}
+	// highpass
+	tr.b0[1] = c / (c + 1.0); tr.b1[1] = -tr.b0[1];
+	tr.a1[1] = (1.0 - c) / (1.0 + c);
+	tr.c0[1] = n * c * c; tr.c1[1] = -2.0 * n * c * c; tr.c2[1] = n * c * c;
+	tr.d1[1] = d1; tr.d2[1] = d2;
+	// lowpass
+	tr.b0[2] = 1.0 / (c + 1.0); tr.b1[2] = tr.b0[2];
+	tr.a1[2] = (1.0 - c) / (1.0 + c);
+	tr.c0[2] = n; tr.c1[2] = 2.0 * n; tr.c2[2] = n;
+	tr.d1[2] = d1; tr.d2[2] = d2;
+}
+
+// lane l of split st as BankBlock k
+static void bank_block(BankBlock& k, const BankStage& st, int l)
+{
+	// direct form of BankStage as y = C s + D x, s' = A s + B x
+	const double e = st.b1[l] - st.b0[l] * st.a1[l];
+	const double A[3][3] = {
+		{ -st.a1[l], 0.0, 0.0 },
+		{ e, -st.d1[l], -st.d2[l] },
+		{ 0.0, 1.0, 0.0 } };
+	const double B[3] = { 1.0, st.b0[l], 0.0 };
+	const double C[3] = { st.c0[l] * e, st.c1[l] - st.c0[l] * st.d1[l],
+	                      st.c2[l] - st.c0[l] * st.d2[l] };
+	const double D = st.c0[l] * st.b0[l];
+	// impulse response h[m] and P = A^m, row vector C A^m, column A^m B
+	double h[BANK_BLOCK];
+	double CA[3] = { C[0], C[1], C[2] };
+	double AB[BANK_BLOCK][3];
+	AB[0][0] = B[0]; AB[0][1] = B[1]; AB[0][2] = B[2];
+	h[0] = D;
+	for (int m = 0; m < BANK_BLOCK; m++) {
+		for (int i = 0; i < 3; i++) k.o[i][m] = CA[i];
+		if (m + 1 < BANK_BLOCK) {
+			h[m + 1] = CA[0] * B[0] + CA[1] * B[1] + CA[2] * B[2];
+			for (int i = 0; i < 3; i++)
+				AB[m + 1][i] = A[i][0] * AB[m][0] + A[i][1] * AB[m][1] + A[i][2] * AB[m][2];
+		}
+		double t[3];
+		for (int i = 0; i < 3; i++)
+			t[i] = CA[0] * A[0][i] + CA[1] * A[1][i] + CA[2] * A[2][i];
+		for (int i = 0; i < 3; i++) CA[i] = t[i];
+	}
+	for (int j = 0; j < BANK_BLOCK; j++) {
+		for (int m = 0; m < BANK_BLOCK; m++) k.h[j][m] = (m >= j) ? h[m - j] : 0.0;
+		for (int i = 0; i < 3; i++) k.g[j][i] = AB[BANK_BLOCK - 1 - j][i];
+		k.g[j][3] = 0.0;
+	}
+	// A^BANK_BLOCK, column i is the state after the block from state i
+	for (int i = 0; i < 3; i++) {
+		double v[3] = { 0.0, 0.0, 0.0 };
+		v[i] = 1.0;
+		for (int m = 0; m < BANK_BLOCK; m++) {
+			double t[3];
+			for (int r = 0; r < 3; r++)
+				t[r] = A[r][0] * v[0] + A[r][1] * v[1] + A[r][2] * v[2];
+			for (int r = 0; r < 3; r++) v[r] = t[r];
+		}
+		for (int r = 0; r < 3; r++) k.a[i][r] = v[r];
+		k.a[i][3] = 0.0;
+	}
+}
+
+static double mr_bessel_i0(double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 32; k++) {
+		term *= (0.5 * x / k) * (0.5 * x / k);
+		sum += term;
+	}
+	return sum;
+}
+
+static void bank_multirate(BankConst& k, double fs)
+{
+	// largest power of two that keeps the decimated rate above MR_RATE
+	k.dec = 1;
+	while (k.dec < MR_DEC_MAX && fs / (2 * k.dec) >= MR_RATE) k.dec *= 2;
+	const double rate = fs / k.dec;
+	// the decimator takes the lowpass output of the first split which is
+	// low enough against the decimated rate
+	int s = 0;
+	while (s < BANK_STAGES && bank_xover[s] / (M_PI * rate) > MR_EDGE) s++;
+	if (s == BANK_STAGES) k.dec = 1;
+	k.decSplit = std::min<int>(s + 1, BANK_STAGES);
+	// The splits below are the bilinear transform of the same analog
+	// prototypes as at full rate, with the frequency scale fitted at the
+	// crossover where both paths overlap. Prewarped to their own crossovers
+	// instead, the phase of the two paths drifts apart by a degree or two
+	// there, which shows as a 0.1 dB bump in the sum.
+	const double xe = bank_xover[k.decSplit - 1];
+	const double warp = std::tan(xe / rate) / bank_prewarp(k.decSplit - 1, fs);
+	for (int j = k.decSplit; j < BANK_STAGES; j++) {
+		tree_init(k.treeLow[j], j, bank_prewarp(j, fs) * warp);
+	}
+	// kaiser windowed sinc with the cutoff at half the decimated rate,
+	// anti-alias and anti-image filter alike
+	const int taps = k.dec * MR_PHASE;
+	double sum = 0.0;
+	for (int j = 0; j < MR_TAPS; j++) k.decCoef[j] = 0.0;
+	for (int j = 0; j < taps; j++) {
+		const double t = (j - 0.5 * (taps - 1)) / k.dec;
+		const double r = 2.0 * j / (taps - 1) - 1.0;
+		const double w = mr_bessel_i0(MR_BETA * std::sqrt(std::max<double>(0.0, 1.0 - r * r)))
+			/ mr_bessel_i0(MR_BETA);
+		k.decCoef[j] = w * (t == 0.0 ? 1.0 : std::sin(M_PI * t) / (M_PI * t));
+		sum += k.decCoef[j];
+	}
+	for (int j = 0; j < taps; j++) k.decCoef[j] /= sum;
+	// polyphase branches of the interpolator, gain dec
+	for (int p = 0; p < MR_DEC_MAX; p++) {
+		for (int i = 0; i < MR_PHASE; i++) {
+			k.intCoef[p][i] = (p < k.dec) ? k.dec * k.decCoef[p + i * k.dec] : 0.0;
+		}
+	}
+}
+
+// coefficients of the bank at sample rate fs
+static void bank_const(BankConst& k, double fs)
+{
+	const uint64_t ones = ~uint64_t(0);
+	for (int s = 0; s < BANK_STAGES; s++) {
+		BankStage& st = k.stage[s];
+		double t = bank_prewarp(s, fs);
+		double c = 1.0 / t;
+		double n = 1.0 / ((c + 1.0) * c + 1.0);
+		double d1 = n * 2.0 * (1.0 - c * c);
+		double d2 = n * ((c - 1.0) * c + 1.0);
+		for (int l = 0; l < BANK_LANES; l++) {
+			if (l < s) { // allpass
+				st.b0[l] = 1.0; st.b1[l] = 0.0; st.a1[l] = 0.0;
+				st.c0[l] = d2; st.c1[l] = d1; st.c2[l] = 1.0;
+			} else if (l == s) { // highpass
+				st.b0[l] = c / (c + 1.0); st.b1[l] = -st.b0[l];
+				st.a1[l] = (1.0 - c) / (1.0 + c);
+				st.c0[l] = n * c * c; st.c1[l] = -2.0 * n * c * c; st.c2[l] = n * c * c;
+			} else if (l == s + 1) { // lowpass
+				st.b0[l] = 1.0 / (c + 1.0); st.b1[l] = st.b0[l];
+				st.a1[l] = (1.0 - c) / (1.0 + c);
+				st.c0[l] = n; st.c1[l] = 2.0 * n; st.c2[l] = n;
+			} else { // unused lane
+				st.b0[l] = 0.0; st.b1[l] = 0.0; st.a1[l] = 0.0;
+				st.c0[l] = 0.0; st.c1[l] = 0.0; st.c2[l] = 0.0;
+			}
+			// the first split takes the input on all lanes
+			if (s == 0 || l == s + 1)
+				memcpy(&st.lp[l], &ones, sizeof(ones));
+			else
+				st.lp[l] = 0.0;
+			if (l <= s + 1) {
+				st.d1[l] = d1; st.d2[l] = d2;
+			} else {
+				st.d1[l] = 0.0; st.d2[l] = 0.0;
+			}
+		}
+	}
+	for (int s = 0; s < BANK_STAGES; s++) {
+		for (int l = 0; l <= s + 1; l++) bank_block(k.block[s * (s + 3) / 2 + l], k.stage[s], l);
+	}
+	for (int s = 0; s < BANK_STAGES; s++) tree_init(k.tree[s], s, bank_prewarp(s, fs));
+	for (int s = 0; s < BANK_STAGES; s++) {
+		const double c = 1.0 / bank_prewarp(s, fs);
+		const double n = 1.0 / ((c + 1.0) * c + 1.0);
+		k.flat[s][0] = n * 2.0 * (1.0 - c * c);
+		k.flat[s][1] = n * ((c - 1.0) * c + 1.0);
+	}
+	bank_multirate(k, fs);
+#ifdef MATCHEQ_FLOAT
+	const uint32_t onesf = ~uint32_t(0);
+	k.split = 0;
+	while (k.split < BANK_STAGES && bank_xover[k.split] / fs >= BANK_FLOAT_MIN) k.split++;
+	for (int s = 0; s < k.split; s++) {
+		const BankStage& st = k.stage[s];
+		BankStageT<float>& sf = k.stageF[s];
+		for (int l = 0; l < BANK_LANES; l++) {
+			if (s == 0 || l == s + 1)
+				memcpy(&sf.lp[l], &onesf, sizeof(onesf));
+			else
+				sf.lp[l] = 0.0f;
+			sf.b0[l] = st.b0[l]; sf.b1[l] = st.b1[l]; sf.a1[l] = st.a1[l];
+			sf.c0[l] = st.c0[l]; sf.c1[l] = st.c1[l]; sf.c2[l] = st.c2[l];
+			sf.d1[l] = st.d1[l]; sf.d2[l] = st.d2[l];
+		}
+	}
+#endif
+	for (int n = 0; n < BANK_CHUNK; n++) k.index[n] = n + 1;
+}
+
+void SimdBank::init(const BankConst *k, double fs)
+{
+	fConst = k;
+	fFloor = 1.0 / fs;
+	fMode = METER_PEAK;
+	set_meter(METER_PEAK, 4096);
+	clear_energy();
+	clear_state();
+}
+
+// state of the bank and the tree, engine 1 and 2
+void SimdBank::clear_sections()
+{
+	for (int s = 0; s < BANK_STAGES; s++) {
+		for (int l = 0; l < BANK_LANES; l++) {
+			fStage[s].z1[l] = 0.0;
+			fStage[s].q1[l] = 0.0;
+			fStage[s].q2[l] = 0.0;
+		}
+	}
+	for (int s = 0; s < BANK_STAGES; s++) {
+		for (int l = 0; l < TREE_LANES; l++) {
+			fTree[s].z1[l] = 0.0;
+			fTree[s].q1[l] = 0.0;
+			fTree[s].q2[l] = 0.0;
+		}
+	}
+#ifdef MATCHEQ_FLOAT
+	for (int s = 0; s < BANK_STAGES; s++) {
+		for (int l = 0; l < BANK_LANES; l++) {
+			fStageF[s].z1[l] = 0.0f;
+			fStageF[s].q1[l] = 0.0f;
+			fStageF[s].q2[l] = 0.0f;
+		}
+	}
+	for (int l = 0; l < BANK_LANES; l++) fBufF[l] = 0.0f;
+#endif
+	for (int l = 0; l < BANK_LANES; l++) fBuf[l] = 0.0;
+}
+
+void SimdBank::clear_state()
+{
+	clear_sections();
+	clear_flat();
+	for (int s = 0; s < BANK_STAGES; s++) {
+		for (int l = 0; l < TREE_LANES; l++) {
+			fTreeLow[s].z1[l] = 0.0;
+			fTreeLow[s].q1[l] = 0.0;
+			fTreeLow[s].q2[l] = 0.0;
+		}
+	}
+	for (int s = 0; s < BANK_STAGES; s++) {
+		for (int k = 0; k < 3; k++) fApState[s][k] = 0.0;
+	}
+	for (int k = 0; k < 2 * MR_TAPS; k++) fDecHist[k] = 0.0;
+	for (int k = 0; k < 2 * MR_PHASE; k++) fIntHist[k] = 0.0;
+	for (int k = 0; k < MR_DELAY; k++) {
+		fDelayDry[k] = 0.0;
+		fDelaySum[k] = 0.0;
+	}
+	fDecPos = 0;
+	fIntPos = 0;
+	fDelayPos = 0;
+	fPhase = 0;
+	fDecReset = false;
+	for (int s = 0; s < BANK_STAGES; s++) {
+		for (int k = 0; k < 3; k++) {
+			for (int c = 0; c < BANK_CHANNELS; c++) {
+				fChTree[s][k].z1[c] = 0.0;
+				fChTree[s][k].q1[c] = 0.0;
+				fChTree[s][k].q2[c] = 0.0;
+			}
+		}
+	}
+	for (int l = 0; l < BANK_BANDS; l++) {
+		for (int c = 0; c < BANK_CHANNELS; c++) {
+			fChEnv[l][c] = 0.0;
+			fChHold[l][c] = 0.0;
+		}
+	}
+	for (int l = 0; l < BANK_LANES; l++) {
+		fEnv[l] = 0.0;
+		fHold[l] = 0.0;
+	}
+	fCount = 0;
+}
+
+void SimdBank::clear_flat()
+{
+	for (int s = 0; s < BANK_STAGES; s++) {
+		fFlatQ[s][0] = 0.0;
+		fFlatQ[s][1] = 0.0;
+	}
+}
+
+// All band gains equal (engine 1 and 2). The lowpass and the highpass of
+// a split add up to the allpass of its lane 0 in the tree,
+//
+//   LP_s + HP_s = A_s = (1 - s + s^2) / (1 + s + s^2)  (prewarped)
+//
+// because the first order pole cancels against the zero of 1 + s^3, so
+// the bank is the cascade of the ten split allpasses, one biquad each,
+// times the common gain. through leaves out the allpasses.
+void SimdBank::compute_flat(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0,
+                            const BankParam& p, bool through)
+{
+	const BankConst& kc = *fConst;
+	for (int i = 0; i < count; i++) {
+		const double k = i + 1;
+		const double fMorph = p.morph + k * p.mstep;
+		const double fGain = (p.ingain + k * p.istep) * (p.gain[0] + k * p.gstep[0]);
+		const double fTemp0 = double(input0[i]);
+		double x = fTemp0;
+		if (!through) {
+			for (int s = 0; s < BANK_STAGES; s++) {
+				const double d1 = kc.flat[s][0];
+				const double d2 = kc.flat[s][1];
+				const double u = x - d1 * fFlatQ[s][0] - d2 * fFlatQ[s][1];
+				x = d2 * u + d1 * fFlatQ[s][0] + fFlatQ[s][1];
+				fFlatQ[s][1] = fFlatQ[s][0];
+				fFlatQ[s][0] = u;
+			}
+		}
+		output0[i] = FAUSTFLOAT((1.0 - fMorph) * fTemp0 + fMorph * fGain * x);
+	}
+}
+
+void SimdBank::compute(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0, const BankParam& p)
+{
+	BANK_KERNEL(compute_bank, count, input0, output0, p, 0);
+}
+
+// offset is the position of input0 within the stretch p covers
+template <bool RAMP, int M>
+void always_inline SimdBank::compute_bank(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0,
+                                          const BankParam& p, int offset)
+{
+	typedef BankVec V;
+	typedef V::v vec;
+	const BankConst& kc = *fConst;
+	const vec vfloor = V::set1(fFloor);
+	double sum[V::W] __attribute__((aligned(32)));
+	for (int i = 0; i < count; i++) {
+		const double k = offset + i + 1;
+		const double fMorph = RAMP ? p.morph + k * p.mstep : p.morph;
+		const double fInGain = RAMP ? p.ingain + k * p.istep : p.ingain;
+		double fTemp0 = double(input0[i]);
+		double fLow = fInGain * fTemp0;
+		int s = 0;
+#ifdef MATCHEQ_FLOAT
+		if (kc.split) {
+			float fLowF = float(fLow);
+			for (; s < kc.split; s++) fLowF = bank_split<BankVecF>(kc.stageF[s], fStageF[s], fBufF, fLowF, s);
+			// fixed length so it vectorizes, lanes above split are
+			// rewritten by the double splits
+			for (int l = 0; l < BANK_LANES; l++) fBuf[l] = fBufF[l];
+			fLow = fLowF;
+		}
+#endif
+		for (; s < BANK_STAGES; s++) fLow = bank_split<V>(kc.stage[s], fStage[s], fBuf, fLow, s);
+		// band gains, meters and sum
+		const bool reset = (fCount >= fWindow);
+		const vec vk = V::set1(k);
+		vec acc = V::set1(0.0);
+		for (int l = 0; l < BANK_BANDS; l += V::W) {
+			vec g = V::load(p.gain + l);
+			if (RAMP) g = V::add(g, V::mul(vk, V::load(p.gstep + l)));
+			vec y = V::mul(g, V::load(fBuf + l));
+			acc = V::add(acc, y);
+			if (M == METER_OFF) continue;
+			if (M == METER_MATCH) V::store(fEnergy + l, V::add(V::load(fEnergy + l), V::mul(y, y)));
+			vec a = meter_in<M, V>(y, vfloor);
+			if (reset) {
+				meter_hold<M, V>(fHold + l, fEnv + l, fScale, fFloor);
+				V::store(fEnv + l, a);
+			} else {
+				V::store(fEnv + l, meter_add<M, V>(V::load(fEnv + l), a));
+			}
+		}
+		if (M != METER_OFF) fCount = reset ? 1 : fCount + 1;
+		V::store(sum, acc);
+		double fTemp1 = sum[0];
+		for (int w = 1; w < V::W; w++) fTemp1 += sum[w];
+		output0[i] = FAUSTFLOAT((((1.0 - fMorph) * fTemp0) + (fMorph * fTemp1)));
+	}
+}
+
+// meter of band s for one sample of the tree, which stands for weight
+// samples of the window
+template <int M>
+inline double SimdBank::meter(int s, double y, bool reset, double weight)
+{
+	if (M == METER_OFF) return y;
+	if (M == METER_MATCH) fEnergy[s] += weight * y * y;
+	const double a = (M == METER_RMS) ? weight * y * y : std::max<double>(fFloor, std::fabs(y));
+	if (reset) {
+		fHold[s] = meter_read<M>(fEnv[s], fScale, fFloor);
+		fEnv[s] = a;
+	} else {
+		fEnv[s] = (M == METER_RMS) ? fEnv[s] + a : std::max<double>(fEnv[s], a);
+	}
+	return y;
+}
+
+// Tree topology (engine 2). The bank above gives every band its own
+// chain of allpasses through the splits below it, 65 sections in all.
+// Since the allpasses are linear they can as well run on the partial sum
+// of the bands split off so far, which is Horner's scheme:
+//
+//   sum = A_s(sum) + g_s * HP_s(low),  low = LP_s(low)   for s = 0 .. 9
+//   out = sum + g_10 * low
+//
+// That leaves three sections per split, 29 in all, on four lanes. The
+// transfer function at constant gains is the one of the bank, so the
+// output is magnitude flat at 0 dB. The gain ramps now act ahead of
+// the allpasses, and the band meters see the bands before the phase
+// compensation, so their peak readings differ a little from engine 0/1.
+void SimdBank::compute_tree(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0, const BankParam& p)
+{
+	BANK_KERNEL(compute_tree_t, count, input0, output0, p);
+}
+
+template <bool RAMP, int M>
+void always_inline SimdBank::compute_tree_t(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0,
+                                            const BankParam& p)
+{
+	typedef BankVec V;
+	const BankConst& kc = *fConst;
+	for (int i = 0; i < count; i++) {
+		const double k = i + 1;
+		const double fMorph = RAMP ? p.morph + k * p.mstep : p.morph;
+		const double fInGain = RAMP ? p.ingain + k * p.istep : p.ingain;
+		double fTemp0 = double(input0[i]);
+		double fLow = fInGain * fTemp0;
+		double fSum = 0.0;
+		const bool reset = (fCount >= fWindow);
+		for (int s = 0; s <= BANK_STAGES; s++) {
+			double fBand = fLow;
+			if (s < BANK_STAGES) {
+				tree_split<V>(kc.tree[s], fTree[s], fBuf, fSum, fLow);
+				fSum = fBuf[0];
+				fBand = fBuf[1];
+				fLow = fBuf[2];
+			}
+			const double g = RAMP ? p.gain[s] + k * p.gstep[s] : p.gain[s];
+			fSum += meter<M>(s, g * fBand, reset);
+		}
+		if (M != METER_OFF) fCount = reset ? 1 : fCount + 1;
+		output0[i] = FAUSTFLOAT((((1.0 - fMorph) * fTemp0) + (fMorph * fSum)));
+	}
+}
+
+// Tree topology for up to BANK_CHANNELS channels in lockstep. Here the
+// vector lanes carry the channels instead of the sections, each section
+// of compute_tree() runs once for all of them with its coefficients
+// broadcast, and the gains and the dry/wet mix are shared. analysis picks
+// what the band meters show: 0 the loudest channel (linked), c channel c.
+void SimdBank::compute_channels(int count, int channels, FAUSTFLOAT **inputs, FAUSTFLOAT **outputs,
+                                const BankParam& p, int analysis)
+{
+	BANK_KERNEL(compute_channels_t, count, channels, inputs, outputs, p, analysis);
+}
+
+template <bool RAMP, int M>
+void always_inline SimdBank::compute_channels_t(int count, int channels, FAUSTFLOAT **inputs,
+                                                FAUSTFLOAT **outputs, const BankParam& p, int analysis)
+{
+	typedef BankVec V;
+	typedef V::v vec;
+	const BankConst& kc = *fConst;
+	const vec vfloor = V::set1(fFloor);
+	double lane[V::W] __attribute__((aligned(32)));
+	double wet[V::W] __attribute__((aligned(32)));
+	int counter = fCount;
+	for (int c = 0; c < channels; c += V::W) {
+		const int w = std::min<int>(V::W, channels - c);
+		for (int l = w; l < V::W; l++) lane[l] = 0.0;
+		counter = fCount;
+		for (int i = 0; i < count; i++) {
+			const double k = i + 1;
+			const double fMorph = RAMP ? p.morph + k * p.mstep : p.morph;
+			const double fInGain = RAMP ? p.ingain + k * p.istep : p.ingain;
+			for (int l = 0; l < w; l++) lane[l] = double(inputs[c + l][i]);
+			const vec x = V::load(lane);
+			vec low = V::mul(V::set1(fInGain), x);
+			vec sum = V::set1(0.0);
+			const bool reset = (counter >= fWindow);
+			for (int s = 0; s <= BANK_STAGES; s++) {
+				vec band = low;
+				if (s < BANK_STAGES) {
+					const TreeStage& st = kc.tree[s];
+					if (s) sum = tree_section<V>(st, 0, fChTree[s][0], c, sum);
+					band = tree_section<V>(st, 1, fChTree[s][1], c, low);
+					low = tree_section<V>(st, 2, fChTree[s][2], c, low);
+				}
+				const double g = RAMP ? p.gain[s] + k * p.gstep[s] : p.gain[s];
+				const vec y = V::mul(V::set1(g), band);
+				sum = V::add(sum, y);
+				if (M == METER_OFF) continue;
+				if (M == METER_MATCH)
+					V::store(fChEnergy[s] + c, V::add(V::load(fChEnergy[s] + c), V::mul(y, y)));
+				const vec a = meter_in<M, V>(y, vfloor);
+				if (reset) {
+					meter_hold<M, V>(fChHold[s] + c, fChEnv[s] + c, fScale, fFloor);
+					V::store(fChEnv[s] + c, a);
+				} else {
+					V::store(fChEnv[s] + c, meter_add<M, V>(V::load(fChEnv[s] + c), a));
+				}
+			}
+			if (M != METER_OFF) counter = reset ? 1 : counter + 1;
+			V::store(wet, V::add(V::mul(V::set1(1.0 - fMorph), x), V::mul(V::set1(fMorph), sum)));
+			for (int l = 0; l < w; l++) outputs[c + l][i] = FAUSTFLOAT(wet[l]);
+		}
+	}
+	fCount = counter;
+	if (M == METER_OFF) return;
+	const int a = std::min<int>(analysis, channels);
+	for (int l = 0; l < BANK_BANDS; l++) {
+		double h = fChHold[l][a ? a - 1 : 0];
+		if (!a) {
+			for (int c = 1; c < channels; c++) h = std::max<double>(h, fChHold[l][c]);
+		}
+		fHold[l] = h;
+	}
+	// the energy of the channel the meters show, linked the mean of all
+	if (M != METER_MATCH) return;
+	for (int l = 0; l < BANK_BANDS; l++) {
+		double e = fChEnergy[l][a ? a - 1 : 0];
+		if (!a) {
+			for (int c = 1; c < channels; c++) e += fChEnergy[l][c];
+			e /= channels;
+		}
+		fEnergy[l] = e;
+	}
+}
+
+// run one lane of a split over count samples, count a multiple of
+// BANK_BLOCK, x and y may be the same buffer
+static always_inline void bank_block_lane(const BankBlock& k, double *z1, double *q1, double *q2,
+                                          const double *x, double *y, int count)
+{
+	typedef BankVec V;
+	typedef V::v vec;
+	double s[4] __attribute__((aligned(32))) = { *z1, *q1, *q2, 0.0 };
+	for (int n = 0; n < count; n += BANK_BLOCK) {
+		const vec s0 = V::set1(s[0]);
+		const vec s1 = V::set1(s[1]);
+		const vec s2 = V::set1(s[2]);
+		const vec x0 = V::set1(x[n]);
+		const vec x1 = V::set1(x[n + 1]);
+		const vec x2 = V::set1(x[n + 2]);
+		const vec x3 = V::set1(x[n + 3]);
+		for (int v = 0; v < BANK_BLOCK; v += V::W) {
+			vec t = V::add(V::add(V::mul(V::load(k.a[0] + v), s0), V::mul(V::load(k.a[1] + v), s1)),
+			               V::mul(V::load(k.a[2] + v), s2));
+			t = V::add(t, V::add(V::add(V::mul(V::load(k.g[0] + v), x0), V::mul(V::load(k.g[1] + v), x1)),
+			                     V::add(V::mul(V::load(k.g[2] + v), x2), V::mul(V::load(k.g[3] + v), x3))));
+			vec o = V::add(V::add(V::mul(V::load(k.o[0] + v), s0), V::mul(V::load(k.o[1] + v), s1)),
+			               V::mul(V::load(k.o[2] + v), s2));
+			o = V::add(o, V::add(V::add(V::mul(V::load(k.h[0] + v), x0), V::mul(V::load(k.h[1] + v), x1)),
+			                     V::add(V::mul(V::load(k.h[2] + v), x2), V::mul(V::load(k.h[3] + v), x3))));
+			V::store(y + n + v, o);
+			V::store(s + v, t);
+		}
+	}
+	*z1 = s[0];
+	*q1 = s[1];
+	*q2 = s[2];
+}
+
+// Multirate tree (engine 5). Below a few hundred Hz the splits of the
+// tree run at many times the rate their content needs, and at high sample
+// rates their poles crowd towards z = 1. So the lowpass output of the
+// split at or below MR_EDGE times fs / dec is decimated by dec, the
+// remaining splits and the lowest band run at the decimated rate, and
+// their partial sum is interpolated back:
+//
+//   sum  = A_9 .. A_k(tree_0..k-1(x))            full rate
+//   low  = up(tree_k..9(down(LP_k-1(..(x)))))    fs / dec
+//   out  = delay(sum) + low
+//
+// Decimator and interpolator share one kaiser windowed sinc of
+// dec * MR_PHASE taps, run as polyphase branches, so the low path is
+// delayed by taps - 1 samples, and so are the dry signal and the full rate
+// sum. That is the latency the plugin reports. The allpasses A_k .. A_9
+// go over the sum of a whole chunk afterwards, time blocked like in
+// compute_chunk(), so they don't lengthen the per sample recursion.
+// The decimation dec is 4 at 44.1/48 kHz, 8 at 88.2/96 kHz and 16 at
+// 192 kHz, the splits at 177, 88 and 44 Hz run decimated.
+void SimdBank::compute_multirate(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0, const BankParam& p)
+{
+	for (int n = 0; n < count; n += BANK_CHUNK) {
+		const int c = std::min<int>(BANK_CHUNK, count - n);
+		BANK_KERNEL(compute_decimated, c, input0 + n, output0 + n, p, n);
+	}
+}
+
+// the gains of the decimated bands are taken at the sample which
+// completes their input
+template <bool RAMP, int M>
+void always_inline SimdBank::compute_decimated(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0,
+                                               const BankParam& p, int offset)
+{
+	typedef BankVec V;
+	const BankConst& kc = *fConst;
+	const int taps = kc.dec * MR_PHASE;
+	double *fSum = fChunk[0];
+	double *fLowSum = fChunk[1];
+	for (int i = 0; i < count; i++) {
+		const double k = offset + i + 1;
+		const double fInGain = RAMP ? p.ingain + k * p.istep : p.ingain;
+		double fLow = fInGain * double(input0[i]);
+		double fTemp0 = 0.0;
+		const bool reset = (M != METER_OFF) && (fCount >= fWindow);
+		fDecReset |= reset;
+		for (int s = 0; s < kc.decSplit; s++) {
+			tree_split<V>(kc.tree[s], fTree[s], fBuf, fTemp0, fLow);
+			const double g = RAMP ? p.gain[s] + k * p.gstep[s] : p.gain[s];
+			fTemp0 = fBuf[0] + meter<M>(s, g * fBuf[1], reset);
+			fLow = fBuf[2];
+		}
+		fSum[i] = fTemp0;
+		if (M != METER_OFF) fCount = reset ? 1 : fCount + 1;
+		// decimator, history newest first and stored twice
+		fDecPos = (fDecPos ? fDecPos : taps) - 1;
+		fDecHist[fDecPos] = fLow;
+		fDecHist[fDecPos + taps] = fLow;
+		if (fPhase == kc.dec - 1) {
+			const double *h = fDecHist + fDecPos;
+			double x = 0.0;
+			for (int j = 0; j < taps; j++) x += kc.decCoef[j] * h[j];
+			double y = 0.0;
+			for (int s = kc.decSplit; s < BANK_STAGES; s++) {
+				tree_split<V>(kc.treeLow[s], fTreeLow[s], fBuf, y, x);
+				const double g = RAMP ? p.gain[s] + k * p.gstep[s] : p.gain[s];
+				y = fBuf[0] + meter<M>(s, g * fBuf[1], fDecReset, kc.dec);
+				x = fBuf[2];
+			}
+			const double g = RAMP ? p.gain[BANK_STAGES] + k * p.gstep[BANK_STAGES] : p.gain[BANK_STAGES];
+			y += meter<M>(BANK_STAGES, g * x, fDecReset, kc.dec);
+			fDecReset = false;
+			fIntPos = (fIntPos ? fIntPos : MR_PHASE) - 1;
+			fIntHist[fIntPos] = y;
+			fIntHist[fIntPos + MR_PHASE] = y;
+			fPhase = 0;
+		} else {
+			fPhase++;
+		}
+		// interpolator, branch fPhase
+		const double *c = kc.intCoef[fPhase];
+		const double *h = fIntHist + fIntPos;
+		double y = 0.0;
+		for (int j = 0; j < MR_PHASE; j++) y += c[j] * h[j];
+		fLowSum[i] = y;
+	}
+	// allpasses of the decimated splits on the full rate sum, the state is
+	// the one of the direct form, so the remainder can go sample by sample
+	const int blocked = count - count % BANK_BLOCK;
+	for (int s = kc.decSplit; s < BANK_STAGES; s++) {
+		double *z = fApState[s];
+		bank_block_lane(kc.block[s * (s + 3) / 2], z, z + 1, z + 2, fSum, fSum, blocked);
+		const BankStage& st = kc.stage[s];
+		for (int i = blocked; i < count; i++) {
+			const double u = fSum[i] - st.d1[0] * z[1] - st.d2[0] * z[2];
+			z[0] = fSum[i];
+			fSum[i] = st.c0[0] * u + st.c1[0] * z[1] + st.c2[0] * z[2];
+			z[2] = z[1];
+			z[1] = u;
+		}
+	}
+	// dry and full rate sum delayed to match the low path
+	for (int i = 0; i < count; i++) {
+		const double fMorph = RAMP ? p.morph + (offset + i + 1) * p.mstep : p.morph;
+		fDelayDry[fDelayPos] = double(input0[i]);
+		fDelaySum[fDelayPos] = fSum[i];
+		const int d = (fDelayPos - (taps - 1)) & (MR_DELAY - 1);
+		fDelayPos = (fDelayPos + 1) & (MR_DELAY - 1);
+		output0[i] = FAUSTFLOAT((((1.0 - fMorph) * fDelayDry[d]) + (fMorph * (fDelaySum[d] + fLowSum[i]))));
+	}
+}
+
+// Time blocked variant of compute() for large buffers. The splits run one
+// after the other over BANK_CHUNK samples, every lane as state space update
+// over BANK_BLOCK samples, so the recursion no longer has to wait on the
+// previous sample. The remainder of count below BANK_BLOCK goes through
+// compute().
+void SimdBank::compute_block(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0, const BankParam& p)
+{
+	const int blocked = count - count % BANK_BLOCK;
+	for (int n = 0; n < blocked; n += BANK_CHUNK) {
+		const int c = std::min<int>(BANK_CHUNK, blocked - n);
+		BANK_KERNEL(compute_chunk, c, input0 + n, output0 + n, p, n);
+	}
+	if (blocked < count)
+		BANK_KERNEL(compute_bank, count - blocked, input0 + blocked, output0 + blocked, p, blocked);
+}
+
+template <bool RAMP, int M>
+void always_inline SimdBank::compute_chunk(int count, FAUSTFLOAT *input0, FAUSTFLOAT *output0,
+                                           const BankParam& p, int offset)
+{
+	typedef BankVec V;
+	typedef V::v vec;
+	const BankConst& kc = *fConst;
+	const double *fIndex = kc.index;
+	double *fLow = fMeter; // input of the first split, reused for the meters
+	// input gain
+	if (RAMP) {
+		const double g = p.ingain + offset * p.istep;
+		for (int n = 0; n < count; n++) fLow[n] = (g + fIndex[n] * p.istep) * double(input0[n]);
+	} else {
+		for (int n = 0; n < count; n++) fLow[n] = p.ingain * double(input0[n]);
+	}
+	// the splits, lowpass lane first as it reads the highpass lane's input
+	for (int s = 0; s < BANK_STAGES; s++) {
+		BankState& st = fStage[s];
+		const BankBlock *k = kc.block + s * (s + 3) / 2;
+		const double *x = s ? fChunk[s] : fLow;
+		bank_block_lane(k[s + 1], st.z1 + s + 1, st.q1 + s + 1, st.q2 + s + 1, x, fChunk[s + 1], count);
+		for (int l = 0; l <= s; l++) {
+			bank_block_lane(k[l], st.z1 + l, st.q1 + l, st.q2 + l, l == s ? x : fChunk[l], fChunk[l], count);
+		}
+	}
+	// the meter counter resets at most once per chunk (BANK_CHUNK is
+	// below the shortest window), at sample r
+	const int r = (fWindow - fCount < count) ? std::max<int>(0, fWindow - fCount) : count;
+	if (M != METER_OFF) fCount = (r < count) ? count - r : fCount + count;
+	// band gains and meters, the sum ends up in fChunk[BANK_BANDS]
+	double *fSum = fChunk[BANK_BANDS];
+	const vec vfloor = V::set1(fFloor);
+	for (int l = 0; l < BANK_BANDS; l++) {
+		const vec vg = V::set1(RAMP ? p.gain[l] + offset * p.gstep[l] : p.gain[l]);
+		const vec vs = V::set1(p.gstep[l]);
+		double *y = fChunk[l];
+		for (int n = 0; n < count; n += V::W) {
+			const vec g = RAMP ? V::add(vg, V::mul(vs, V::load(fIndex + n))) : vg;
+			vec v = V::mul(g, V::load(y + n));
+			V::store(y + n, v);
+			V::store(fSum + n, l ? V::add(V::load(fSum + n), v) : v);
+			if (M != METER_OFF) V::store(fMeter + n, meter_in<M, V>(v, vfloor));
+		}
+		if (M == METER_OFF) continue;
+		if (M == METER_MATCH) {
+			double e = fEnergy[l];
+			for (int n = 0; n < count; n++) e += y[n] * y[n];
+			fEnergy[l] = e;
+		}
+		double env = fEnv[l];
+		for (int n = 0; n < r; n++) env = (M == METER_RMS) ? env + fMeter[n] : std::max<double>(env, fMeter[n]);
+		if (r < count) {
+			fHold[l] = meter_read<M>(env, fScale, fFloor);
+			env = fMeter[r];
+			for (int n = r + 1; n < count; n++) env = (M == METER_RMS) ? env + fMeter[n] : std::max<double>(env, fMeter[n]);
+		}
+		fEnv[l] = env;
+	}
+	// dry/wet
+	if (RAMP) {
+		const double m0 = p.morph + offset * p.mstep;
+		for (int n = 0; n < count; n++) {
+			const double m = m0 + fIndex[n] * p.mstep;
+			output0[n] = FAUSTFLOAT((((1.0 - m) * double(input0[n])) + (m * fSum[n])));
+		}
+	} else {
+		const double m = p.morph;
+		for (int n = 0; n < count; n++) {
+			output0[n] = FAUSTFLOAT((((1.0 - m) * double(input0[n])) + (m * fSum[n])));
+		}
+	}
+}
+
+///////////////////////// BATCH OF INSTANCES //////////////////////////
+
+#define BATCH_LANES 4 // instances per block, the widest vector
+
+// Tree topology of four instances at one sample rate, one per lane. Like
+// ChannelSection for the channels, but every lane has its own gains,
+// morph, input gain and meters.
+struct BatchBlock {
+	ChannelSectionT<BATCH_LANES> sec[BANK_STAGES][3];
+	double gain[BANK_BANDS][BATCH_LANES] __attribute__((aligned(32)));
+	double gstep[BANK_BANDS][BATCH_LANES] __attribute__((aligned(32)));
+	double morph[BATCH_LANES] __attribute__((aligned(32)));
+	double mstep[BATCH_LANES] __attribute__((aligned(32)));
+	double ingain[BATCH_LANES] __attribute__((aligned(32)));
+	double istep[BATCH_LANES] __attribute__((aligned(32)));
+	double env[BANK_BANDS][BATCH_LANES] __attribute__((aligned(32)));
+	double hold[BANK_BANDS][BATCH_LANES] __attribute__((aligned(32)));
+	const TreeStage *tree; // coefficients, shared with every block at this rate
+	double floor;
+	int window;
+	int count;
+};
+
+// The filter state of a batch of instances in lane order, see Batch in
+// matcheq.cc. Lane b * BATCH_LANES + l is lane l of block b, the blocks
+// are allocated once in init() and never from the audio thread.
+class BankBatch {
+private:
+	BatchBlock *fBlock;
+	int fBlocks;
+
+	template <bool RAMP>
+	void compute_t(int count, FAUSTFLOAT **inputs, FAUSTFLOAT **outputs);
+
+public:
+	// freed by the owner, a Batch lives in mem_new() memory
+	BankBatch() : fBlock(0), fBlocks(0) {}
+	bool mem_alloc(int blocks);
+	void mem_free();
+	// block b runs at the rate bank was initialized for
+	void set_rate(int b, const SimdBank& bank);
+	void clear_state();
+	void set_param(int lane, const BankParam& p);
+	// inputs and outputs by lane, 0 for the lanes not in use
+	void compute(int count, FAUSTFLOAT **inputs, FAUSTFLOAT **outputs, bool ramp);
+	inline double power(int lane, int band) const {
+		return fBlock[lane / BATCH_LANES].hold[band][lane % BATCH_LANES];
+	}
+};
+
+bool BankBatch::mem_alloc(int blocks)
+{
+	mem_free();
+	void *p = blocks > 0 ? mem_get(blocks * sizeof(BatchBlock)) : 0;
+	if (!p) return false;
+	fBlock = static_cast<BatchBlock*>(p);
+	fBlocks = blocks;
+	for (int b = 0; b < fBlocks; b++) {
+		fBlock[b].tree = 0;
+		fBlock[b].floor = 0.0;
+		fBlock[b].window = 4096;
+	}
+	clear_state();
+	return true;
+}
+
+void BankBatch::mem_free()
+{
+	mem_put(fBlock);
+	fBlock = 0;
+	fBlocks = 0;
+}
+
+void BankBatch::set_rate(int b, const SimdBank& bank)
+{
+	fBlock[b].tree = bank.tree();
+	fBlock[b].floor = bank.floor();
+	fBlock[b].window = bank.window();
+}
+
+void BankBatch::clear_state()
+{
+	for (int b = 0; b < fBlocks; b++) {
+		BatchBlock& bl = fBlock[b];
+		for (int l = 0; l < BATCH_LANES; l++) {
+			for (int s = 0; s < BANK_STAGES; s++) {
+				for (int j = 0; j < 3; j++) {
+					bl.sec[s][j].z1[l] = 0.0;
+					bl.sec[s][j].q1[l] = 0.0;
+					bl.sec[s][j].q2[l] = 0.0;
+				}
+			}
+			for (int s = 0; s < BANK_BANDS; s++) {
+				bl.gain[s][l] = 0.0;
+				bl.gstep[s][l] = 0.0;
+				bl.env[s][l] = 0.0;
+				bl.hold[s][l] = 0.0;
+			}
+			bl.morph[l] = 0.0;
+			bl.mstep[l] = 0.0;
+			bl.ingain[l] = 0.0;
+			bl.istep[l] = 0.0;
+		}
+		bl.count = 0;
+	}
+}
+
+void BankBatch::set_param(int lane, const BankParam& p)
+{
+	BatchBlock& bl = fBlock[lane / BATCH_LANES];
+	const int l = lane % BATCH_LANES;
+	for (int s = 0; s < BANK_BANDS; s++) {
+		bl.gain[s][l] = p.gain[s];
+		bl.gstep[s][l] = p.gstep[s];
+	}
+	bl.morph[l] = p.morph;
+	bl.mstep[l] = p.mstep;
+	bl.ingain[l] = p.ingain;
+	bl.istep[l] = p.istep;
+}
+
+// compute_channels() with the parameters in the lanes too. The sections
+// of a block read the coefficients of its rate, so with all instances at
+// one rate every coefficient is broadcast once per sample for four of
+// them. The output of every lane is the one of compute_tree().
+void BankBatch::compute(int count, FAUSTFLOAT **inputs, FAUSTFLOAT **outputs, bool ramp)
+{
+	if (ramp) compute_t<true>(count, inputs, outputs);
+	else compute_t<false>(count, inputs, outputs);
+}
+
+template <bool RAMP>
+void always_inline BankBatch::compute_t(int count, FAUSTFLOAT **inputs, FAUSTFLOAT **outputs)
+{
+	typedef BankVec V;
+	typedef V::v vec;
+	double lane[V::W] __attribute__((aligned(32)));
+	double wet[V::W] __attribute__((aligned(32)));
+	const vec one = V::set1(1.0);
+	for (int b = 0; b < fBlocks; b++) {
+		BatchBlock& bl = fBlock[b];
+		if (!bl.tree) continue;
+		const vec vfloor = V::set1(bl.floor);
+		int counter = bl.count;
+		for (int c = 0; c < BATCH_LANES; c += V::W) {
+			FAUSTFLOAT **in = inputs + b * BATCH_LANES + c;
+			FAUSTFLOAT **out = outputs + b * BATCH_LANES + c;
+			bool used = false;
+			for (int l = 0; l < V::W; l++) used |= (in[l] != 0);
+			if (!used) continue;
+			counter = bl.count;
+			for (int i = 0; i < count; i++) {
+				const vec k = V::set1(double(i + 1));
+				vec morph = V::load(bl.morph + c);
+				vec ingain = V::load(bl.ingain + c);
+				if (RAMP) {
+					morph = V::add(morph, V::mul(k, V::load(bl.mstep + c)));
+					ingain = V::add(ingain, V::mul(k, V::load(bl.istep + c)));
+				}
+				for (int l = 0; l < V::W; l++) lane[l] = in[l] ? double(in[l][i]) : 0.0;
+				const vec x = V::load(lane);
+				vec low = V::mul(ingain, x);
+				vec sum = V::set1(0.0);
+				const bool reset = (counter >= bl.window);
+				for (int s = 0; s <= BANK_STAGES; s++) {
+					vec band = low;
+					if (s < BANK_STAGES) {
+						const TreeStage& st = bl.tree[s];
+						if (s) sum = tree_section<V>(st, 0, bl.sec[s][0], c, sum);
+						band = tree_section<V>(st, 1, bl.sec[s][1], c, low);
+						low = tree_section<V>(st, 2, bl.sec[s][2], c, low);
+					}
+					vec g = V::load(bl.gain[s] + c);
+					if (RAMP) g = V::add(g, V::mul(k, V::load(bl.gstep[s] + c)));
+					const vec y = V::mul(g, band);
+					sum = V::add(sum, y);
+					const vec a = V::vmax(vfloor, V::vabs(y));
+					if (reset) {
+						V::store(bl.hold[s] + c, V::load(bl.env[s] + c));
+						V::store(bl.env[s] + c, a);
+					} else {
+						V::store(bl.env[s] + c, V::vmax(V::load(bl.env[s] + c), a));
+					}
+				}
+				counter = reset ? 1 : counter + 1;
+				V::store(wet, V::add(V::mul(V::sub(one, morph), x), V::mul(morph, sum)));
+				for (int l = 0; l < V::W; l++) {
+					if (out[l]) out[l][i] = FAUSTFLOAT(wet[l]);
+				}
+			}
+		}
+		bl.count = counter;
+	}
+}
+
+} // end namespace matcheq
@@ -0,0 +1,395 @@
+/*
+ * Copyright (C) 2014 Guitarix project MOD project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * --------------------------------------------------------------------------
+ */
+
+// spectrum analysis of the match captures of matcheq.cc
+//
+// While a capture runs the audio thread only copies the input into a
+// single producer single consumer ring. The LV2 worker thread takes it
+// from there in segments of SPEC_FFT samples with half overlap, windows
+// them (Hann) and adds up their power spectra (Welch). When the capture
+// ends the averaged spectrum is summed into 1/6 or 1/12 octave bands for
+// the GUI, see SPECTRUM_LOW in gx_matcheq.h, and weighted with the power
+// response of each band of the crossover, which gives the band levels the
+// match works with. A capture shorter than a segment is taken as one zero
+// padded segment.
+//
+// The audio thread hands the worker a stretch of the ring at a time
+// (start of the capture, end of the stretch) and leaves the request alone
+// while the state is SPEC_BUSY; the result is there after work_response().
+// Each stretch goes out as its own job with a sequence number, like the
+// designs of DesignRequest, and only the job of the pending stretch works
+// on the ring or answers.
+// A full ring drops input rather than wait for the worker.
+
+namespace matcheq {
+
+// at 44.1/48 kHz, doubled for every octave of sample rate above
+#define SPEC_FFT 16384
+#define SPEC_RING_SEGMENTS 4   // ring length in segments, a power of 2
+
+enum {
+	SPEC_IDLE,      // nothing on the worker
+	SPEC_BUSY,      // worker scheduled, fReq* belong to it
+};
+
+class SpecAnalysis {
+private:
+	int fSize;        // FFT length
+	int fHop;
+	uint32_t fMask;   // ring length - 1
+	double fFs;
+	double fFloor;    // dB
+	FirFFT fFFT;
+	BankResponse fBank;
+	// ring, written by the audio thread, read by the worker
+	float *fRing;
+	std::atomic<uint32_t> fWrite;  // samples pushed
+	std::atomic<uint32_t> fRead;   // samples taken
+	// audio thread
+	bool fRun;          // capture running
+	uint32_t fStart;    // its first sample in the ring
+	uint32_t fSent;     // end of the last stretch handed out
+	int fRes;           // bands per octave
+	bool fFinal;        // a finished capture waits for the worker
+	uint32_t fFinStart;
+	uint32_t fFinEnd;
+	int fFinRes;
+	std::atomic<int> fState;
+	std::atomic<uint32_t> fSeq;   // sequence number of the last request
+	// request, see work_pending()
+	uint32_t fReqStart;
+	uint32_t fReqEnd;
+	int fReqRes;
+	bool fReqFinal;
+	// worker thread
+	bool fOpen;         // fPsd holds the capture at fCapture
+	uint32_t fCapture;
+	int fFill;          // samples in fSeg
+	int fSegments;
+	double fWinPower;   // sum of the squared window
+	double *fSeg;       // fSize
+	double *fWin;       // fSize
+	double *fTime;      // fSize
+	double *fRe;        // fSize / 2 + 1
+	double *fIm;
+	double *fPsd;
+	// result, written by the worker before the response of a final request
+	bool fResult;
+	int fResultRes;
+	float fLevels[SPECTRUM_MAX];  // dB, SPECTRUM_LOW * 2^(j / fResultRes)
+	float fBands[BANK_BANDS];     // dB, G1 .. G11
+	bool mem_allocated;
+
+	void segment(int len);
+	void finish(int res);
+
+public:
+	SpecAnalysis();
+	~SpecAnalysis() { mem_free(); }
+	void init(double fs, double floor);
+	void mem_alloc();
+	void mem_free();
+	inline bool ready() const { return mem_allocated; }
+	// audio thread
+	void start(int res);
+	bool stop();
+	inline void push(int count, const FAUSTFLOAT *input, double gain);
+	inline void push_channels(int count, int channels, FAUSTFLOAT **inputs, int analysis, double gain);
+	uint32_t work_pending();
+	bool work_response(uint32_t seq);
+	int result(float *levels, float *bands) const;
+	// worker thread
+	void work(uint32_t seq);
+};
+
+SpecAnalysis::SpecAnalysis()
+	: fSize(0), fHop(0), fMask(0), fFs(0), fFloor(0), fRing(0), fWrite(0), fRead(0),
+	  fRun(false), fStart(0), fSent(0), fRes(6), fFinal(false), fFinStart(0),
+	  fFinEnd(0), fFinRes(6), fState(SPEC_IDLE), fSeq(0), fReqStart(0), fReqEnd(0),
+	  fReqRes(6), fReqFinal(false), fOpen(false), fCapture(0), fFill(0),
+	  fSegments(0), fWinPower(0), fSeg(0), fWin(0), fTime(0), fRe(0), fIm(0),
+	  fPsd(0), fResult(false), fResultRes(6), mem_allocated(false) {
+	for (int j = 0; j < SPECTRUM_MAX; j++) fLevels[j] = 0.0f;
+	for (int b = 0; b < BANK_BANDS; b++) fBands[b] = 0.0f;
+}
+
+void SpecAnalysis::init(double fs, double floor)
+{
+	const int r = fir_scale(fs);
+	if (mem_allocated && SPEC_FFT * r != fSize) mem_free();
+	fSize = SPEC_FFT * r;
+	fHop = fSize / 2;
+	fMask = uint32_t(SPEC_RING_SEGMENTS * fSize - 1);
+	fFs = fs;
+	fFloor = floor;
+	fBank.init(fs);
+}
+
+void SpecAnalysis::mem_alloc()
+{
+	if (mem_allocated) return;
+	const int bins = fSize / 2 + 1;
+	fFFT.mem_alloc(fSize);
+	fRing = mem_new<float>(fMask + 1);
+	fSeg = mem_new<double>(fSize);
+	fWin = mem_new<double>(fSize);
+	fTime = mem_new<double>(fSize);
+	fRe = mem_new<double>(bins);
+	fIm = mem_new<double>(bins);
+	fPsd = mem_new<double>(bins);
+	fWinPower = 0.0;
+	for (int i = 0; i < fSize; i++) {
+		fWin[i] = 0.5 - 0.5 * std::cos(2.0 * M_PI * i / fSize);
+		fWinPower += fWin[i] * fWin[i];
+	}
+	fWrite.store(0);
+	fRead.store(0);
+	fRun = false;
+	fFinal = false;
+	fState.store(SPEC_IDLE, std::memory_order_release);
+	fOpen = false;
+	fResult = false;
+	mem_allocated = true;
+}
+
+void SpecAnalysis::mem_free()
+{
+	if (!mem_allocated) return;
+	mem_allocated = false;
+	fFFT.mem_free();
+	mem_put(fRing);
+	mem_put(fSeg);
+	mem_put(fWin);
+	mem_put(fTime);
+	mem_put(fRe);
+	mem_put(fIm);
+	mem_put(fPsd);
+	fRing = 0;
+	fSeg = fWin = fTime = fRe = fIm = fPsd = 0;
+}
+
+// audio thread: a capture starts, res bands per octave
+void SpecAnalysis::start(int res)
+{
+	if (!mem_allocated) return;
+	fRun = true;
+	fStart = fSent = fWrite.load(std::memory_order_relaxed);
+	fRes = res;
+}
+
+// audio thread: the capture ends, true when its result comes from the
+// worker. Not while the one before is still on its way there.
+bool SpecAnalysis::stop()
+{
+	if (!fRun) return false;
+	fRun = false;
+	if (fFinal || (fState.load(std::memory_order_relaxed) == SPEC_BUSY && fReqFinal)) return false;
+	fFinal = true;
+	fFinStart = fStart;
+	fFinEnd = fWrite.load(std::memory_order_relaxed);
+	fFinRes = fRes;
+	return true;
+}
+
+// audio thread: the capture input, scaled by the input gain
+inline void SpecAnalysis::push(int count, const FAUSTFLOAT *input, double gain)
+{
+	if (!fRun) return;
+	const uint32_t w = fWrite.load(std::memory_order_relaxed);
+	const uint32_t space = fMask + 1 - (w - fRead.load(std::memory_order_acquire));
+	const int n = std::min<int>(count, int(space));
+	const float g = float(gain);
+	for (int i = 0; i < n; i++) fRing[(w + i) & fMask] = g * input[i];
+	fWrite.store(w + n, std::memory_order_release);
+}
+
+// the channel the meters show, linked the mean of all channels. That is
+// their mid signal, which sits below the mean of their levels the meters
+// take when the channels are not correlated; the match only looks at the
+// difference of two captures.
+inline void SpecAnalysis::push_channels(int count, int channels, FAUSTFLOAT **inputs,
+                                        int analysis, double gain)
+{
+	if (!fRun) return;
+	if (analysis > 0 && analysis <= channels) {
+		push(count, inputs[analysis - 1], gain);
+		return;
+	}
+	const uint32_t w = fWrite.load(std::memory_order_relaxed);
+	const uint32_t space = fMask + 1 - (w - fRead.load(std::memory_order_acquire));
+	const int n = std::min<int>(count, int(space));
+	const float g = float(gain / channels);
+	for (int i = 0; i < n; i++) {
+		float x = 0.0f;
+		for (int c = 0; c < channels; c++) x += inputs[c][i];
+		fRing[(w + i) & fMask] = g * x;
+	}
+	fWrite.store(w + n, std::memory_order_release);
+}
+
+// audio thread: the sequence number of the job the caller schedules, 0
+// for none. A finished capture first, else every hop of a running one.
+uint32_t SpecAnalysis::work_pending()
+{
+	if (fState.load(std::memory_order_relaxed) != SPEC_IDLE) return 0;
+	if (fFinal) {
+		fFinal = false;
+		fReqStart = fFinStart;
+		fReqEnd = fFinEnd;
+		fReqRes = fFinRes;
+		fReqFinal = true;
+	} else if (fRun && fWrite.load(std::memory_order_relaxed) - fSent >= uint32_t(fHop)) {
+		fSent = fWrite.load(std::memory_order_relaxed);
+		fReqStart = fStart;
+		fReqEnd = fSent;
+		fReqRes = fRes;
+		fReqFinal = false;
+	} else {
+		return 0;
+	}
+	uint32_t seq = (fSeq.load(std::memory_order_relaxed) + 1) & JOB_SEQ_MASK;
+	if (!seq) seq = 1;
+	fSeq.store(seq, std::memory_order_relaxed);
+	// hands fReq* over to the worker
+	fState.store(SPEC_BUSY, std::memory_order_release);
+	return seq;
+}
+
+// audio thread, between two run() calls: true when a result is ready.
+// The response of a stale job leaves the pending one alone.
+bool SpecAnalysis::work_response(uint32_t seq)
+{
+	if (fState.load(std::memory_order_relaxed) != SPEC_BUSY ||
+	    fSeq.load(std::memory_order_relaxed) != seq) return false;
+	fState.store(SPEC_IDLE, std::memory_order_release);
+	return fReqFinal && fResult;
+}
+
+// audio thread: the result of the last final request, the number of
+// levels, SPECTRUM_OCTAVES * res + 1
+int SpecAnalysis::result(float *levels, float *bands) const
+{
+	if (!fResult) return 0;
+	const int n = SPECTRUM_OCTAVES * fResultRes + 1;
+	for (int j = 0; j < n; j++) levels[j] = fLevels[j];
+	for (int b = 0; b < BANK_BANDS; b++) bands[b] = fBands[b];
+	return n;
+}
+
+// worker thread: windowed power spectrum of the first len samples of fSeg,
+// one sided and scaled to mean square per bin
+void SpecAnalysis::segment(int len)
+{
+	double power = fWinPower;
+	if (len == fSize) {
+		for (int i = 0; i < fSize; i++) fTime[i] = fSeg[i] * fWin[i];
+	} else {
+		power = 0.0;
+		for (int i = 0; i < len; i++) {
+			const double w = 0.5 - 0.5 * std::cos(2.0 * M_PI * i / len);
+			fTime[i] = fSeg[i] * w;
+			power += w * w;
+		}
+		for (int i = len; i < fSize; i++) fTime[i] = 0.0;
+	}
+	if (power <= 0.0) return;
+	fFFT.forward(fTime, fRe, fIm);
+	const int m = fSize / 2;
+	const double scale = 2.0 / (double(fSize) * power);
+	for (int k = 0; k <= m; k++) {
+		const double p = fRe[k] * fRe[k] + fIm[k] * fIm[k];
+		fPsd[k] += ((k == 0 || k == m) ? 0.5 * scale : scale) * p;
+	}
+	fSegments++;
+}
+
+// worker thread: the bands of the averaged spectrum
+void SpecAnalysis::finish(int res)
+{
+	if (!fSegments && fFill > 1) segment(fFill);
+	const int m = fSize / 2;
+	const double norm = fSegments ? 1.0 / fSegments : 0.0;
+	for (int k = 0; k <= m; k++) fPsd[k] *= norm;
+	// bin k covers k - 1/2 .. k + 1/2 of the bin spacing, a band takes the
+	// part of each bin it overlaps
+	const double spacing = fFs / fSize;
+	const int n = SPECTRUM_OCTAVES * res + 1;
+	for (int j = 0; j < n; j++) {
+		const double f = SPECTRUM_LOW * std::pow(2.0, double(j) / res);
+		const double edge = std::pow(2.0, 0.5 / res);
+		const double lo = f / edge / spacing + 0.5;
+		const double hi = std::min<double>(f * edge / spacing + 0.5, m + 1.0);
+		double p = 0.0;
+		for (int k = int(lo); k < hi; k++)
+			p += fPsd[k] * (std::min<double>(hi, k + 1.0) - std::max<double>(lo, double(k)));
+		fLevels[j] = (p > 0.0) ? float(std::max<double>(fFloor, 10. * log10(p))) : float(fFloor);
+	}
+	// power through each band of the crossover
+	double band[BANK_BANDS] = {0.0};
+	double mag2[BANK_BANDS];
+	for (int k = 0; k <= m; k++) {
+		if (fPsd[k] <= 0.0) continue;
+		fBank.bands(M_PI * k / m, mag2);
+		for (int b = 0; b < BANK_BANDS; b++) band[b] += fPsd[k] * mag2[b];
+	}
+	for (int b = 0; b < BANK_BANDS; b++) {
+		const double p = band[BANK_BANDS - 1 - b];
+		fBands[b] = (p > 0.0) ? float(std::max<double>(fFloor, 10. * log10(p))) : float(fFloor);
+	}
+	fResultRes = res;
+	fResult = true;
+	fOpen = false;
+}
+
+// worker thread: take the stretch of the request out of the ring
+void SpecAnalysis::work(uint32_t seq)
+{
+	if (fState.load(std::memory_order_acquire) != SPEC_BUSY ||
+	    fSeq.load(std::memory_order_relaxed) != seq || !mem_allocated) return;
+	uint32_t r = fRead.load(std::memory_order_relaxed);
+	if (!fOpen || fCapture != fReqStart) {
+		// a new capture, what is left of the last one goes
+		fOpen = true;
+		fCapture = fReqStart;
+		fFill = 0;
+		fSegments = 0;
+		for (int k = 0; k <= fSize / 2; k++) fPsd[k] = 0.0;
+		r = fReqStart;
+	}
+	// pairs with the store in push(), the stretch is in the ring
+	if (fWrite.load(std::memory_order_acquire) - r < fReqEnd - r) return;
+	while (r != fReqEnd) {
+		const int n = std::min<int>(fSize - fFill, int(fReqEnd - r));
+		for (int i = 0; i < n; i++) fSeg[fFill + i] = fRing[(r + i) & fMask];
+		fFill += n;
+		r += n;
+		if (fFill == fSize) {
+			segment(fSize);
+			for (int i = 0; i < fHop; i++) fSeg[i] = fSeg[fHop + i];
+			fFill = fSize - fHop;
+		}
+	}
+	fRead.store(r, std::memory_order_release);
+	if (fReqFinal) {
+		fResult = false;
+		finish(fReqRes);
+	}
+}
+
+} // end namespace matcheq
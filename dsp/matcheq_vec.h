@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2014 Guitarix project MOD project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * --------------------------------------------------------------------------
+ */
+
+// Vector support for the filterbank kernels in matcheq_simd.cc and the
+// crossfade of the plugin wrapper. Each build of the dsp gets the widest
+// vectors its instruction set has, see gx_matcheq_dsp.cpp: AVX, SSE2 or
+// NEON, and the scalar fallback when NOSSE is defined. The generic build
+// uses the latter on any CPU, so on x86 MATCHEQ_DSP=generic runs the code
+// the ARM boards without NEON run.
+
+#pragma once
+
+#ifndef _MATCHEQ_VEC_H
+#define _MATCHEQ_VEC_H
+
+#if (defined(__SSE__) || defined(__AVX__)) && !defined(NOSSE)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && !defined(NOSSE)
+#include <arm_neon.h>
+#endif
+
+namespace matcheq {
+
+///////////////////////// VECTOR SUPPORT ///////////////////////////////
+
+#if defined(__AVX__) && !defined(NOSSE)
+
+struct BankVec {
+	typedef double T;
+	typedef __m256d v;
+	static const int W = 4;
+	static always_inline v load(const double *p) { return _mm256_load_pd(p); }
+	static always_inline void store(double *p, v a) { _mm256_store_pd(p, a); }
+	static always_inline v set1(double a) { return _mm256_set1_pd(a); }
+	static always_inline v add(v a, v b) { return _mm256_add_pd(a, b); }
+	static always_inline v sub(v a, v b) { return _mm256_sub_pd(a, b); }
+	static always_inline v mul(v a, v b) { return _mm256_mul_pd(a, b); }
+	static always_inline v vmax(v a, v b) { return _mm256_max_pd(a, b); }
+	static always_inline v vabs(v a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+	static always_inline v blend(v a, v b, v m) { return _mm256_blendv_pd(a, b, m); }
+};
+
+#elif defined(__SSE2__) && !defined(NOSSE)
+
+struct BankVec {
+	typedef double T;
+	typedef __m128d v;
+	static const int W = 2;
+	static always_inline v load(const double *p) { return _mm_load_pd(p); }
+	static always_inline void store(double *p, v a) { _mm_store_pd(p, a); }
+	static always_inline v set1(double a) { return _mm_set1_pd(a); }
+	static always_inline v add(v a, v b) { return _mm_add_pd(a, b); }
+	static always_inline v sub(v a, v b) { return _mm_sub_pd(a, b); }
+	static always_inline v mul(v a, v b) { return _mm_mul_pd(a, b); }
+	static always_inline v vmax(v a, v b) { return _mm_max_pd(a, b); }
+	static always_inline v vabs(v a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+	static always_inline v blend(v a, v b, v m) { return _mm_or_pd(_mm_andnot_pd(m, a), _mm_and_pd(m, b)); }
+};
+
+#elif defined(__aarch64__) && defined(__ARM_NEON) && !defined(NOSSE)
+
+// 32 bit ARM has no double precision NEON and takes the scalar fallback
+struct BankVec {
+	typedef double T;
+	typedef float64x2_t v;
+	static const int W = 2;
+	static always_inline v load(const double *p) { return vld1q_f64(p); }
+	static always_inline void store(double *p, v a) { vst1q_f64(p, a); }
+	static always_inline v set1(double a) { return vdupq_n_f64(a); }
+	static always_inline v add(v a, v b) { return vaddq_f64(a, b); }
+	static always_inline v sub(v a, v b) { return vsubq_f64(a, b); }
+	static always_inline v mul(v a, v b) { return vmulq_f64(a, b); }
+	static always_inline v vmax(v a, v b) { return vmaxq_f64(a, b); }
+	static always_inline v vabs(v a) { return vabsq_f64(a); }
+	static always_inline v blend(v a, v b, v m) { return vbslq_f64(vreinterpretq_u64_f64(m), b, a); }
+};
+
+#else
+
+struct BankVec {
+	typedef double T;
+	typedef double v;
+	static const int W = 1;
+	static always_inline v load(const double *p) { return *p; }
+	static always_inline void store(double *p, v a) { *p = a; }
+	static always_inline v set1(double a) { return a; }
+	static always_inline v add(v a, v b) { return a + b; }
+	static always_inline v sub(v a, v b) { return a - b; }
+	static always_inline v mul(v a, v b) { return a * b; }
+	static always_inline v vmax(v a, v b) { return std::max<double>(a, b); }
+	static always_inline v vabs(v a) { return std::fabs(a); }
+	static always_inline v blend(v a, v b, v m) { uint64_t k; memcpy(&k, &m, sizeof(k)); return k ? b : a; }
+};
+
+#endif
+
+// single precision, for the float splits and the bypass crossfade of the
+// plugin wrapper; loadu/storeu are for host buffers
+#if defined(__AVX__) && !defined(NOSSE)
+
+struct BankVecF {
+	typedef float T;
+	typedef __m256 v;
+	static const int W = 8;
+	static always_inline v load(const float *p) { return _mm256_load_ps(p); }
+	static always_inline void store(float *p, v a) { _mm256_store_ps(p, a); }
+	static always_inline v set1(float a) { return _mm256_set1_ps(a); }
+	static always_inline v add(v a, v b) { return _mm256_add_ps(a, b); }
+	static always_inline v sub(v a, v b) { return _mm256_sub_ps(a, b); }
+	static always_inline v mul(v a, v b) { return _mm256_mul_ps(a, b); }
+	static always_inline v blend(v a, v b, v m) { return _mm256_blendv_ps(a, b, m); }
+	static always_inline v loadu(const float *p) { return _mm256_loadu_ps(p); }
+	static always_inline void storeu(float *p, v a) { _mm256_storeu_ps(p, a); }
+	static always_inline v vmin(v a, v b) { return _mm256_min_ps(a, b); }
+	static always_inline v vmax(v a, v b) { return _mm256_max_ps(a, b); }
+};
+
+#elif defined(__SSE__) && !defined(NOSSE)
+
+struct BankVecF {
+	typedef float T;
+	typedef __m128 v;
+	static const int W = 4;
+	static always_inline v load(const float *p) { return _mm_load_ps(p); }
+	static always_inline void store(float *p, v a) { _mm_store_ps(p, a); }
+	static always_inline v set1(float a) { return _mm_set1_ps(a); }
+	static always_inline v add(v a, v b) { return _mm_add_ps(a, b); }
+	static always_inline v sub(v a, v b) { return _mm_sub_ps(a, b); }
+	static always_inline v mul(v a, v b) { return _mm_mul_ps(a, b); }
+	static always_inline v blend(v a, v b, v m) { return _mm_or_ps(_mm_andnot_ps(m, a), _mm_and_ps(m, b)); }
+	static always_inline v loadu(const float *p) { return _mm_loadu_ps(p); }
+	static always_inline void storeu(float *p, v a) { _mm_storeu_ps(p, a); }
+	static always_inline v vmin(v a, v b) { return _mm_min_ps(a, b); }
+	static always_inline v vmax(v a, v b) { return _mm_max_ps(a, b); }
+};
+
+#elif defined(__ARM_NEON) && !defined(NOSSE)
+
+struct BankVecF {
+	typedef float T;
+	typedef float32x4_t v;
+	static const int W = 4;
+	static always_inline v load(const float *p) { return vld1q_f32(p); }
+	static always_inline void store(float *p, v a) { vst1q_f32(p, a); }
+	static always_inline v set1(float a) { return vdupq_n_f32(a); }
+	static always_inline v add(v a, v b) { return vaddq_f32(a, b); }
+	static always_inline v sub(v a, v b) { return vsubq_f32(a, b); }
+	static always_inline v mul(v a, v b) { return vmulq_f32(a, b); }
+	static always_inline v blend(v a, v b, v m) { return vbslq_f32(vreinterpretq_u32_f32(m), b, a); }
+	static always_inline v loadu(const float *p) { return vld1q_f32(p); }
+	static always_inline void storeu(float *p, v a) { vst1q_f32(p, a); }
+	static always_inline v vmin(v a, v b) { return vminq_f32(a, b); }
+	static always_inline v vmax(v a, v b) { return vmaxq_f32(a, b); }
+};
+
+#else
+
+struct BankVecF {
+	typedef float T;
+	typedef float v;
+	static const int W = 1;
+	static always_inline v load(const float *p) { return *p; }
+	static always_inline void store(float *p, v a) { *p = a; }
+	static always_inline v set1(float a) { return a; }
+	static always_inline v add(v a, v b) { return a + b; }
+	static always_inline v sub(v a, v b) { return a - b; }
+	static always_inline v mul(v a, v b) { return a * b; }
+	static always_inline v blend(v a, v b, v m) { uint32_t k; memcpy(&k, &m, sizeof(k)); return k ? b : a; }
+	static always_inline v loadu(const float *p) { return *p; }
+	static always_inline void storeu(float *p, v a) { *p = a; }
+	static always_inline v vmin(v a, v b) { return std::min<float>(a, b); }
+	static always_inline v vmax(v a, v b) { return std::max<float>(a, b); }
+};
+
+#endif
+
+} // end namespace matcheq
+
+#endif /* !_MATCHEQ_VEC_H */
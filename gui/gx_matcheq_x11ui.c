@@ -5,6 +5,9 @@
 
 #include "lv2/lv2plug.in/ns/lv2core/lv2.h"
 #include "lv2/lv2plug.in/ns/extensions/ui/ui.h"
+#include "lv2/lv2plug.in/ns/ext/urid/urid.h"
+#include "lv2/lv2plug.in/ns/ext/atom/util.h"
+#include "lv2/lv2plug.in/ns/ext/patch/patch.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -284,6 +287,24 @@ typedef struct {
     float c_states_set[11];
     int first_match;
     bool analyse;
+    // the spectra of the match captures come from the dsp on the NOTIFY
+    // port, without urid:map from the meters
+    LV2_URID_Map* map;
+    LV2_URID atom_eventTransfer;
+    LV2_URID atom_Object;
+    LV2_URID atom_URID;
+    LV2_URID atom_Vector;
+    LV2_URID atom_Float;
+    LV2_URID patch_Set;
+    LV2_URID patch_property;
+    LV2_URID patch_value;
+    LV2_URID match1;
+    LV2_URID match2;
+    LV2_URID spectrum1;
+    LV2_URID spectrum2;
+    // fractional octave levels of the captures, see SPECTRUM_LOW
+    float spectrum[2][SPECTRUM_MAX];
+    int spectrum_res[2];    // bands per octave, 0 for none
 
     void *controller;
     LV2UI_Write_Function write_function;
@@ -340,6 +361,7 @@ static LV2UI_Handle instantiate(const LV2UI_Descriptor * descriptor,
     }
 
     ui->parentXwindow = 0;
+    ui->map = NULL;
     LV2UI_Resize* resize = NULL;
 
     for (int i = 0; features[i]; ++i) {
@@ -347,9 +369,27 @@ static LV2UI_Handle instantiate(const LV2UI_Descriptor * descriptor,
             ui->parentXwindow = features[i]->data;
         } else if (!strcmp(features[i]->URI, LV2_UI__resize)) {
             resize = (LV2UI_Resize*)features[i]->data;
+        } else if (!strcmp(features[i]->URI, LV2_URID__map)) {
+            ui->map = (LV2_URID_Map*)features[i]->data;
         }
     }
 
+    if (ui->map) {
+        LV2_URID_Map* map = ui->map;
+        ui->atom_eventTransfer = map->map(map->handle, LV2_ATOM__eventTransfer);
+        ui->atom_Object = map->map(map->handle, LV2_ATOM__Object);
+        ui->atom_URID = map->map(map->handle, LV2_ATOM__URID);
+        ui->atom_Vector = map->map(map->handle, LV2_ATOM__Vector);
+        ui->atom_Float = map->map(map->handle, LV2_ATOM__Float);
+        ui->patch_Set = map->map(map->handle, LV2_PATCH__Set);
+        ui->patch_property = map->map(map->handle, LV2_PATCH__property);
+        ui->patch_value = map->map(map->handle, LV2_PATCH__value);
+        ui->match1 = map->map(map->handle, GXPLUGIN_PARAM "MATCH1");
+        ui->match2 = map->map(map->handle, GXPLUGIN_PARAM "MATCH2");
+        ui->spectrum1 = map->map(map->handle, GXPLUGIN_PARAM "SPECTRUM1");
+        ui->spectrum2 = map->map(map->handle, GXPLUGIN_PARAM "SPECTRUM2");
+    }
+
     if (ui->parentXwindow == NULL)  {
         debug_print("ERROR: Failed to open parentXwindow for %s\n", plugin_uri);
         free(ui);
@@ -408,6 +448,7 @@ static LV2UI_Handle instantiate(const LV2UI_Descriptor * descriptor,
         ui->c_states2[i] = 0.0;
         ui->c_states_set[i] = 0.0;
     }
+    ui->spectrum_res[0] = ui->spectrum_res[1] = 0;
     ui->analyse = False;
     ui->first_match = 1;
 
@@ -976,6 +1017,32 @@ static void db_slider_expose(gx_matcheqUI *ui, int i) {
     cairo_new_path (ui->crm);
 }
 
+// the spectra of the captures over the octave of band b, Match1 like
+// its marker, Match2 in grey. A 1/R octave band is R times below the
+// octave, so the levels go up by 10 log10(R) to the scale of the meter.
+static void spectrum_expose(gx_matcheqUI *ui, int b) {
+    const double center = 31.25 * pow(2.0, b);
+    for (int s=0;s<2;s++) {
+        const int res = ui->spectrum_res[s];
+        if (!res) continue;
+        const double shift = 10.0 * log10((double)res);
+        bool first = true;
+        for (int j=0;j<=SPECTRUM_OCTAVES*res;j++) {
+            const double oct = log2(SPECTRUM_LOW * pow(2.0, (double)j/res) / center);
+            if (oct < -0.5 || oct > 0.5) continue;
+            const double x = 3.0 + 12.0 * (oct + 0.5);
+            const double y = 216.0 - 216.0 * log_meter(ui->spectrum[s][j] + shift);
+            if (first) cairo_move_to(ui->crm, x, y);
+            else cairo_line_to(ui->crm, x, y);
+            first = false;
+        }
+        if (s == 0) cairo_set_source_surface (ui->crm, ui->meter_prof, 3, 0);
+        else cairo_set_source_rgb (ui->crm, 0.6, 0.6, 0.6);
+        cairo_set_line_width(ui->crm, 1.0);
+        cairo_stroke(ui->crm);
+    }
+}
+
 // draw the meter (V)
 static void meter_expose(gx_matcheqUI *ui,  int i, gx_controller* meter_) {
     cairo_set_operator(ui->crm,CAIRO_OPERATOR_CLEAR);
@@ -996,6 +1063,7 @@ static void meter_expose(gx_matcheqUI *ui,  int i, gx_controller* meter_) {
     cairo_set_source_surface (ui->crm, ui->meter_prof, 3, 0);
     cairo_rectangle(ui->crm,3, 216-(216 * log_meter(ui->c_states[i-12])), 12, 3);
     cairo_fill(ui->crm);
+    spectrum_expose(ui, i-12);
    
     cairo_new_path (ui->crm);
     db_slider_expose(ui, i);
@@ -1373,6 +1441,7 @@ static void load_profile(void *ui_, void* user_data) {
     for (int a=0;a<11;a++) {
         ui->c_states[a] = ui->p[i].c_states[a];
     }
+    ui->spectrum_res[0] = 0;
     if (ui->first_match) {
         ui->first_match = 0;
         send_controller_event(ui, 24);
@@ -1602,18 +1671,77 @@ static void clear_event(gx_matcheqUI *ui, float v) {
     check_value_changed(ui, 26, &v);
 }
 
+// a match capture ended, levels in dB of the bands of G1 .. G11
+static void match_finish(gx_matcheqUI *ui, int match, const float* levels) {
+    float v = 0.0;
+    // SPECTRUM1/2 follows when the dsp has it
+    ui->spectrum_res[match-1] = 0;
+    if (match == 1) {
+        for (int a=0;a<11;a++) {
+            ui->c_states[a] = max(-70.0,levels[a]);
+        }
+        ui->current_profile = "unsaved";
+        ui->analyse = False;
+        _expose(ui);
+    } else {
+        for (int a=0;a<11;a++) {
+            ui->c_states2[a] = max(-70.0,levels[a]);
+            ui->c_states_set[a] = ui->c_states[a] - ui->c_states2[a];
+            v = max(v,ui->c_states_set[a]);
+        }
+        if(v>10.0) v = -(10.0-v);
+        else v = 0.0;
+        send_analyse_event(ui, v);
+        ui->analyse = False;
+    }
+}
+
+// the levels of a capture from the meters, when the dsp can't send them
+static void match_meters(gx_matcheqUI *ui, int match) {
+    float levels[11];
+    for (int a=0;a<11;a++) {
+        levels[a] = ui->controls[a+12].adj.old_max_value;
+    }
+    match_finish(ui, match, levels);
+}
+
+// the fractional octave levels of a capture, after its band levels
+static void match_spectrum(gx_matcheqUI *ui, int match, const float* levels, int n) {
+    const int res = (n - 1) / SPECTRUM_OCTAVES;
+    if (n > SPECTRUM_MAX || res * SPECTRUM_OCTAVES + 1 != n) return;
+    memcpy(ui->spectrum[match-1], levels, n * sizeof(float));
+    ui->spectrum_res[match-1] = res;
+    _expose(ui);
+}
+
+// patch:Set of MATCH1, MATCH2, SPECTRUM1 or SPECTRUM2 on the NOTIFY port
+static void match_event(gx_matcheqUI *ui, const LV2_Atom* atom) {
+    if (atom->type != ui->atom_Object) return;
+    const LV2_Atom_Object* obj = (const LV2_Atom_Object*)atom;
+    if (obj->body.otype != ui->patch_Set) return;
+    const LV2_Atom* property = NULL;
+    const LV2_Atom* value = NULL;
+    lv2_atom_object_get(obj, ui->patch_property, &property, ui->patch_value, &value, 0);
+    if (!property || !value || property->type != ui->atom_URID || value->type != ui->atom_Vector) return;
+    const LV2_Atom_Vector* vec = (const LV2_Atom_Vector*)value;
+    if (vec->body.child_type != ui->atom_Float ||
+        vec->atom.size < sizeof(LV2_Atom_Vector_Body) + 11 * sizeof(float)) return;
+    const float* levels = (const float*)LV2_ATOM_CONTENTS_CONST(LV2_Atom_Vector, vec);
+    const LV2_URID key = ((const LV2_Atom_URID*)property)->body;
+    const int n = (vec->atom.size - sizeof(LV2_Atom_Vector_Body)) / sizeof(float);
+    if (key == ui->match1) match_finish(ui, 1, levels);
+    else if (key == ui->match2) match_finish(ui, 2, levels);
+    else if (key == ui->spectrum1) match_spectrum(ui, 1, levels, n);
+    else if (key == ui->spectrum2) match_spectrum(ui, 2, levels, n);
+}
+
 /*------------- check and set state of controllers ---------------*/
 
 static void check_switch_state(gx_matcheqUI *ui, int i, float* value) {
-    float v = 0.0;
     if(i == 23) {
         if ((int)(*value) == 0) {
-            for (int a=0;a<11;a++) {
-                ui->c_states[a] = max(-70.0,ui->controls[a+12].adj.old_max_value);
-           }
-            ui->current_profile = "unsaved";
-            ui->analyse = False;
-            _expose(ui);
+            // the dsp sends the levels of the capture on NOTIFY
+            if (!ui->map) match_meters(ui, 1);
         } else {
             float zero = 0.0;
             for (int a=0;a<11;a++) {
@@ -1634,15 +1762,7 @@ static void check_switch_state(gx_matcheqUI *ui, int i, float* value) {
             return;
         }
         if ((int)(*value) == 0) {
-            for (int a=0;a<11;a++) {
-                ui->c_states2[a] = max(-70.0,ui->controls[a+12].adj.old_max_value);
-                ui->c_states_set[a] = ui->c_states[a] - ui->c_states2[a];
-                v = max(v,ui->c_states_set[a]);
-            }
-            if(v>10.0) v = -(10.0-v);
-            else v = 0.0;
-            send_analyse_event(ui, v);
-            ui->analyse = False;
+            if (!ui->map) match_meters(ui, 2);
         } else {
             float zero = 0.0;
             for (int a=0;a<11;a++) {
@@ -1661,6 +1781,7 @@ static void check_switch_state(gx_matcheqUI *ui, int i, float* value) {
                 ui->c_states2[i] = 0.0;
                 ui->c_states_set[i] = 0.0;
             }
+            ui->spectrum_res[1] = 0;
             send_analyse_event(ui, zero);
             send_clear_event(ui, zero);
         }
@@ -2121,6 +2242,11 @@ static void port_event(LV2UI_Handle handle, uint32_t port_index,
                         uint32_t buffer_size, uint32_t format,
                         const void * buffer) {
     gx_matcheqUI* ui = (gx_matcheqUI*)handle;
+    if (port_index == NOTIFY) {
+        if (ui->map && format == ui->atom_eventTransfer)
+            match_event(ui, (const LV2_Atom*)buffer);
+        return;
+    }
     float value = *(float*)buffer;
     for (int i=0;i<CONTROLS;i++) {
         if (port_index == ui->controls[i].port) {
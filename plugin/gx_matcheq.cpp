@@ -20,11 +20,24 @@
 
 #include <cstdlib>
 #include <cmath>
+#include <complex>
 #include <iostream>
 #include <cstring>
 #include <unistd.h>
+#include <new>
+#include <type_traits>
+#include <sys/mman.h>
 
-///////////////////////// DENORMAL PROTECTION WITH SSE /////////////////
+#include "lv2/lv2plug.in/ns/ext/worker/worker.h"
+#include "lv2/lv2plug.in/ns/ext/options/options.h"
+#include "lv2/lv2plug.in/ns/ext/buf-size/buf-size.h"
+#include "lv2/lv2plug.in/ns/ext/urid/urid.h"
+#include "lv2/lv2plug.in/ns/ext/atom/atom.h"
+#include "lv2/lv2plug.in/ns/ext/atom/util.h"
+#include "lv2/lv2plug.in/ns/ext/atom/forge.h"
+#include "lv2/lv2plug.in/ns/ext/patch/patch.h"
+
+///////////////////////// DENORMAL PROTECTION //////////////////////////
 
 #ifdef NOSSE
 #undef __SSE__
@@ -47,44 +60,135 @@
 #endif
 #endif //__SSE3__
 
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__ARM_FP))
+/* On ARM set FZ (Flush to Zero) in FPCR, FPSCR on 32 bit ARM, NEON
+   flushes single precision denormals on its own */
+#define FPCR_FZ (1UL << 24)
 #endif //__SSE__
 
+#ifdef __arm__
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
 ///////////////////////// MACRO SUPPORT ////////////////////////////////
 
-#define __rt_func __attribute__((section(".rt.text")))
-#define __rt_data __attribute__((section(".rt.data")))
+// minimal buffer size for the time blocked processing mode
+#define BLOCK_MODE_MIN 128
+// size of the dry buffer when the host doesn't tell options:maxBlockLength
+#define DRY_BUF_DEFAULT 8192
+// length of the bypass/match crossfade
+#define XFADE_MS 50.0
+// the controls which the CONTROL port sets too, G1 .. G11 first
+#define CTL_MORPH 11
+#define CTL_BYPASS 12
+#define CTLS 13
+#define CTL_GAINS CTLS  // the GAINS parameter, G1 .. G11 at once
 
-///////////////////////// FAUST SUPPORT ////////////////////////////////
+////////////////////////////// LOCAL INCLUDES //////////////////////////
 
-#define FAUSTFLOAT float
-#ifndef N_
-#define N_(String) (String)
-#endif
-#define max(x, y) (((x) > (y)) ? (x) : (y))
-#define min(x, y) (((x) < (y)) ? (x) : (y))
+#include "gx_matcheq.h"        // define struct PortIndex
+#include "gx_pluginlv2.h"   // define struct PluginLV2
+#include "gx_matcheq_dsp.h"    // macro support, the builds of the dsp
+#include "gx_matcheq_batch.h"  // the batch API exported below
+#include "matcheq_vec.h"      // vector types for the crossfade
 
-#define always_inline inline __attribute__((always_inline))
+///////////////////////// MEMORY ///////////////////////////////////////
 
-#ifndef signbit
-#define signbit(x) std::signbit(x)
-#endif
+// MATCHEQ_ALLOC_CHECK: 0 off, 1 report, 2 abort, read at instantiate
+static int mem_check = 0;
+// set by run() while the check is on
+static __thread bool mem_in_run = false;
 
-template<class T> inline T mydsp_faustpower2_f(T x) {return (x * x);}
-template<class T> inline T mydsp_faustpower3_f(T x) {return ((x * x) * x);}
-template<class T> inline T mydsp_faustpower4_f(T x) {return (((x * x) * x) * x);}
-template<class T> inline T mydsp_faustpower5_f(T x) {return ((((x * x) * x) * x) * x);}
-template<class T> inline T mydsp_faustpower6_f(T x) {return (((((x * x) * x) * x) * x) * x);}
+static void mem_checked(const char* what, size_t bytes)
+{
+  std::cerr << "GxMatchEQ: " << what << " of " << bytes
+            << " bytes in run()" << std::endl;
+  if (mem_check > 1)
+    abort();
+}
 
-////////////////////////////// LOCAL INCLUDES //////////////////////////
+void *mem_get(size_t bytes)
+{
+  if (mem_in_run)
+    mem_checked("allocation", bytes);
+  void* p = NULL;
+  if (posix_memalign(&p, MEM_ALIGN, bytes ? bytes : 1))
+    return NULL;
+  return p;
+}
 
-#include "gx_matcheq.h"        // define struct PortIndex
-#include "gx_pluginlv2.h"   // define struct PluginLV2
-#include "matcheq.cc"    // dsp class generated by faust -> dsp2cc
+void mem_put(void *p)
+{
+  if (mem_in_run && p)
+    mem_checked("free", 0);
+  free(p);
+}
 
 ////////////////////////////// PLUG-IN CLASS ///////////////////////////
 
 namespace matcheq {
 
+// Memory of an instance: the plug-in class, the dsp class, the dry
+// buffer and the dry delay line, cut at MEM_ALIGN from one block of whole pages. activate()
+// touches and locks the pages, so the first run() takes no page faults.
+class Arena
+{
+private:
+  char*  base;
+  size_t size;
+  size_t used;
+  bool   locked;
+
+public:
+  static size_t round(size_t bytes) {
+    return (bytes + MEM_ALIGN - 1) & ~size_t(MEM_ALIGN - 1);
+  }
+  bool reserve(size_t bytes) {
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size = (bytes + page - 1) / page * page;
+    void* p = NULL;
+    if (posix_memalign(&p, page, size))
+      return false;
+    base = static_cast<char*>(p);
+    return true;
+  }
+  // bytes from the reserve, which the caller sized with round()
+  void* take(size_t bytes) {
+    void* p = base + used;
+    used += round(bytes);
+    return p;
+  }
+  void prefault() {
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    volatile char* p = base;
+    for (size_t i = 0; i < size; i += page)
+      p[i] = p[i];
+    // fails without the rights (RLIMIT_MEMLOCK), the pages are in anyway
+    if (!locked)
+      locked = !mlock(base, size);
+  }
+  void release() {
+    if (locked)
+      munlock(base, size);
+    free(base);
+    base = NULL;
+    locked = false;
+  }
+  Arena() : base(NULL), size(0), used(0), locked(false) {}
+};
+
+// entry points of a build of the dsp
+struct DspBuild {
+  size_t     (*size)();
+  PluginLV2* (*place)(void* mem);
+  int        (*max_latency)(uint32_t rate);
+  PluginLV2* (*plugin)();
+  BatchLV2*  (*batch)(PluginLV2** instances, int count);
+};
+
+#define DSP_BUILD(ns) {ns::size, ns::place, ns::max_latency, ns::plugin, ns::batch}
+
 class DenormalProtection
 {
 private:
@@ -92,19 +196,52 @@ private:
   uint32_t  mxcsr_mask;
   uint32_t  mxcsr;
   uint32_t  old_mxcsr;
+#elif defined(FPCR_FZ)
+  unsigned long fpcr;
+  unsigned long old_fpcr;
+
+  static inline unsigned long get_fpcr_() {
+    unsigned long r;
+#ifdef __aarch64__
+    __asm__ __volatile__ ("mrs %0, fpcr" : "=r" (r));
+#else
+    __asm__ __volatile__ ("vmrs %0, fpscr" : "=r" (r));
+#endif
+    return r;
+  }
+  static inline void set_fpcr_(unsigned long r) {
+#ifdef __aarch64__
+    __asm__ __volatile__ ("msr fpcr, %0" : : "r" (r));
+#else
+    __asm__ __volatile__ ("vmsr fpscr, %0" : : "r" (r));
+#endif
+  }
 #endif
 
 public:
+  // writing MXCSR serializes the pipeline, which shows at small buffers,
+  // so skip it when the host runs with flush to zero already, the same
+  // goes for FPCR
   inline void set_() {
 #ifdef __SSE__
     old_mxcsr = _mm_getcsr();
-    mxcsr = old_mxcsr;
-    _mm_setcsr((mxcsr | _MM_DENORMALS_ZERO_MASK | _MM_FLUSH_ZERO_MASK) & mxcsr_mask);
+    mxcsr = (old_mxcsr | _MM_DENORMALS_ZERO_MASK | _MM_FLUSH_ZERO_MASK) & mxcsr_mask;
+    if (mxcsr != old_mxcsr)
+      _mm_setcsr(mxcsr);
+#elif defined(FPCR_FZ)
+    old_fpcr = get_fpcr_();
+    fpcr = old_fpcr | FPCR_FZ;
+    if (fpcr != old_fpcr)
+      set_fpcr_(fpcr);
 #endif
   };
   inline void reset_() {
 #ifdef __SSE__
-    _mm_setcsr(old_mxcsr);
+    if (mxcsr != old_mxcsr)
+      _mm_setcsr(old_mxcsr);
+#elif defined(FPCR_FZ)
+    if (fpcr != old_fpcr)
+      set_fpcr_(old_fpcr);
 #endif
   };
 
@@ -120,6 +257,9 @@ public:
     uint32_t mask = *(reinterpret_cast<uint32_t *>(&fxsave[0x1c])); // Obtain the MXCSR mask from FXSAVE structure
     if (mask != 0)
         mxcsr_mask = mask;
+#elif defined(FPCR_FZ)
+    fpcr       = 0;
+    old_fpcr   = 0;
 #endif
   };
 
@@ -129,11 +269,15 @@ public:
 class Gx_matcheq_
 {
 private:
-  // pointer to buffer
-  float*          output;
-  float*          input;
+  // pointer to buffer, one per channel
+  float*          output[BANK_CHANNELS];
+  float*          input[BANK_CHANNELS];
+  // 1 for the mono plugin, 2 stereo, BANK_CHANNELS multichannel
+  uint32_t        channels;
   // pointer to dsp class
   PluginLV2*      matcheq;
+  // the memory of this instance, dsp class included
+  Arena           arena;
   DenormalProtection MXCSR;
 
   // bypass ramping
@@ -143,6 +287,44 @@ private:
   uint32_t        match2_;
   float*          clear;
   uint32_t        clear_;
+  float*          engine;
+  uint32_t        engine_;
+  float*          latency;
+  // copy of the input for the bypass ramps when processing in place,
+  // dry_size samples per channel in the arena
+  float*          dry_buf;
+  uint32_t        dry_size;
+  // the dry path of the ramps and of bypass is delayed by the latency of
+  // the engine, so both sides of a crossfade line up and the latency the
+  // host compensates doesn't jump. Only the mono engines have latency:
+  // channel 0, delay_size (a power of 2) samples in the arena.
+  float*          delay_buf;
+  uint32_t        delay_size;
+  uint32_t        delay_pos;
+  // samples after a clear until the engine output is valid
+  uint32_t        ramp_wait;
+  // LV2 worker, runs the filter design of the linear phase mode
+  LV2_Worker_Schedule* schedule;
+  // sample accurate automation: the dsp class and the bypass read
+  // ctl_value, which takes the control port when the host moves it and
+  // the patch:Set events of the CONTROL port in between
+  const LV2_Atom_Sequence* control;
+  float*          ctl_port[CTLS];
+  float           ctl_host[CTLS];
+  float           ctl_value[CTLS];
+  LV2_URID        urid_object;
+  LV2_URID        urid_set;
+  LV2_URID        urid_property;
+  LV2_URID        urid_value;
+  LV2_URID        urid_float;
+  LV2_URID        urid_vector;
+  LV2_URID        urid_urid;
+  LV2_URID        urid_param[CTLS + 1];  // CTL_GAINS last
+  // the spectra of the match captures go out on NOTIFY
+  LV2_Atom_Sequence* notify;
+  LV2_Atom_Forge  forge;
+  LV2_URID        urid_match[2];
+  LV2_URID        urid_spectrum[2];
 
   bool            needs_ramp_down;
   bool            needs_ramp_up;
@@ -152,9 +334,18 @@ private:
   float           ramp_down_step;
   bool            bypassed;
   bool            no_clear;
+  bool            engine_changed;
 
   // private functions
   inline void run_dsp_(uint32_t n_samples);
+  inline void run_part_(uint32_t offset, uint32_t n_samples, uint32_t n_ch);
+  inline int control_(const LV2_Atom* atom, const LV2_Atom** value);
+  inline void set_control_(int k, const LV2_Atom* value);
+  inline void map_controls_(LV2_URID_Map* map);
+  inline void notify_();
+  inline void process_(uint32_t offset, uint32_t n_samples, uint32_t n_ch);
+  inline float crossfade_(float* out, const float* dry, uint32_t n_samples,
+                          float pos, float dir, float step);
   inline void connect_(uint32_t port,void* data);
   inline void init_dsp_(uint32_t rate);
   inline void connect_all__ports(uint32_t port, void* data);
@@ -165,24 +356,76 @@ private:
 public:
   // LV2 Descriptor
   static const LV2_Descriptor descriptor;
+  static const LV2_Descriptor descriptor_stereo;
+  static const LV2_Descriptor descriptor_multi;
   // static wrapper to private functions
   static void deactivate(LV2_Handle instance);
   static void cleanup(LV2_Handle instance);
+  static LV2_Worker_Status work(LV2_Handle instance,
+                                LV2_Worker_Respond_Function respond,
+                                LV2_Worker_Respond_Handle handle,
+                                uint32_t size, const void* data);
+  static LV2_Worker_Status work_response(LV2_Handle instance,
+                                         uint32_t size, const void* data);
+  static const void* extension_data(const char* uri);
   static void run(LV2_Handle instance, uint32_t n_samples);
   static void activate(LV2_Handle instance);
   static void connect_port(LV2_Handle instance, uint32_t port, void* data);
   static LV2_Handle instantiate(const LV2_Descriptor* descriptor,
                                 double rate, const char* bundle_path,
                                 const LV2_Feature* const* features);
-  Gx_matcheq_();
+  Gx_matcheq_(PluginLV2* dsp);
   ~Gx_matcheq_();
 };
 
+// the build of the dsp for the CPU we run on. MATCHEQ_DSP=generic, sse2,
+// avx2, avx512 or neon in the environment forces a build, for testing, as
+// long as the CPU has it.
+static DspBuild select_dsp()
+{
+  static const char* names[DSP_BUILDS] = {"generic", "sse2", "avx2", "avx512", "neon"};
+  DspBuild builds[DSP_BUILDS] = {DSP_BUILD(matcheq_generic)};
+  bool has[DSP_BUILDS] = {true, false, false, false, false};
+#ifdef DSP_X86
+  builds[DSP_SSE2] = DSP_BUILD(matcheq_sse2);
+  builds[DSP_AVX2] = DSP_BUILD(matcheq_avx2);
+  builds[DSP_AVX512] = DSP_BUILD(matcheq_avx512);
+  __builtin_cpu_init();
+  has[DSP_SSE2] = __builtin_cpu_supports("sse2");
+  has[DSP_AVX2] = has[DSP_SSE2] && __builtin_cpu_supports("avx2")
+                  && __builtin_cpu_supports("fma");
+  has[DSP_AVX512] = has[DSP_AVX2] && __builtin_cpu_supports("avx512f")
+                    && __builtin_cpu_supports("avx512vl")
+                    && __builtin_cpu_supports("avx512dq");
+#endif
+#ifdef DSP_ARM
+  builds[DSP_NEON] = DSP_BUILD(matcheq_neon);
+#ifdef __aarch64__
+  has[DSP_NEON] = true;
+#else
+  has[DSP_NEON] = (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+#endif
+#endif
+  int b = DSP_BUILDS - 1;
+  while (!has[b]) b--;
+  const char* force = getenv("MATCHEQ_DSP");
+  if (force) {
+    int f = 0;
+    while (f < DSP_BUILDS && strcmp(force, names[f])) f++;
+    if (f < DSP_BUILDS && has[f])
+      b = f;
+    else
+      std::cerr << "GxMatchEQ: MATCHEQ_DSP=" << force
+                << " is not available, using " << names[b] << std::endl;
+  }
+  return builds[b];
+}
+
 // constructor
-Gx_matcheq_::Gx_matcheq_() :
-  output(NULL),
-  input(NULL),
-  matcheq(matcheq::plugin()),
+Gx_matcheq_::Gx_matcheq_(PluginLV2* dsp) :
+  channels(1),
+  matcheq(dsp),
+  arena(),
   MXCSR(),
   bypass(0),
   bypass_(2),
@@ -190,10 +433,45 @@ Gx_matcheq_::Gx_matcheq_() :
   match2_(0),
   clear(0),
   clear_(0),
+  engine(0),
+  engine_(UINT32_MAX),
+  latency(0),
+  dry_buf(NULL),
+  dry_size(DRY_BUF_DEFAULT),
+  delay_buf(NULL),
+  delay_size(0),
+  delay_pos(0),
+  ramp_wait(0),
+  schedule(0),
+  control(NULL),
+  urid_object(0),
+  urid_set(0),
+  urid_property(0),
+  urid_value(0),
+  urid_float(0),
+  urid_vector(0),
+  urid_urid(0),
+  notify(NULL),
   needs_ramp_down(false),
   needs_ramp_up(false),
   bypassed(false),
-  no_clear(true) {};
+  no_clear(true),
+  engine_changed(false) {
+  for (int c = 0; c < BANK_CHANNELS; c++) {
+    output[c] = NULL;
+    input[c] = NULL;
+  }
+  // the first run() takes all controls from the ports
+  for (int k = 0; k < CTLS; k++) {
+    ctl_port[k] = NULL;
+    ctl_host[k] = NAN;
+    ctl_value[k] = 0.0f;
+  }
+  for (int k = 0; k <= CTLS; k++)
+    urid_param[k] = 0;
+  urid_match[0] = urid_match[1] = 0;
+  urid_spectrum[0] = urid_spectrum[1] = 0;
+};
 
 // destructor
 Gx_matcheq_::~Gx_matcheq_()
@@ -208,10 +486,35 @@ Gx_matcheq_::~Gx_matcheq_()
 
 ///////////////////////// PRIVATE CLASS  FUNCTIONS /////////////////////
 
+// the URIDs of the CONTROL port
+void Gx_matcheq_::map_controls_(LV2_URID_Map* map)
+{
+  static const char* uris[CTLS + 1] = {
+    GXPLUGIN_PARAM "G1", GXPLUGIN_PARAM "G2", GXPLUGIN_PARAM "G3",
+    GXPLUGIN_PARAM "G4", GXPLUGIN_PARAM "G5", GXPLUGIN_PARAM "G6",
+    GXPLUGIN_PARAM "G7", GXPLUGIN_PARAM "G8", GXPLUGIN_PARAM "G9",
+    GXPLUGIN_PARAM "G10", GXPLUGIN_PARAM "G11", GXPLUGIN_PARAM "MORPH",
+    GXPLUGIN_PARAM "BYPASS", GXPLUGIN_PARAM "GAINS"};
+  urid_object = map->map(map->handle, LV2_ATOM__Object);
+  urid_set = map->map(map->handle, LV2_PATCH__Set);
+  urid_property = map->map(map->handle, LV2_PATCH__property);
+  urid_value = map->map(map->handle, LV2_PATCH__value);
+  urid_float = map->map(map->handle, LV2_ATOM__Float);
+  urid_vector = map->map(map->handle, LV2_ATOM__Vector);
+  urid_urid = map->map(map->handle, LV2_ATOM__URID);
+  for (int k = 0; k <= CTLS; k++)
+    urid_param[k] = map->map(map->handle, uris[k]);
+  urid_match[0] = map->map(map->handle, GXPLUGIN_PARAM "MATCH1");
+  urid_match[1] = map->map(map->handle, GXPLUGIN_PARAM "MATCH2");
+  urid_spectrum[0] = map->map(map->handle, GXPLUGIN_PARAM "SPECTRUM1");
+  urid_spectrum[1] = map->map(map->handle, GXPLUGIN_PARAM "SPECTRUM2");
+  lv2_atom_forge_init(&forge, map);
+}
+
 void Gx_matcheq_::init_dsp_(uint32_t rate)
 {
   // set values for internal ramping
-  ramp_down_step = 32 * (256 * rate) / 48000; 
+  ramp_down_step = max(1, static_cast<int>(XFADE_MS * 0.001 * rate + 0.5));
   ramp_up_step = ramp_down_step;
   ramp_down = ramp_down_step;
   ramp_up = 0.0;
@@ -225,10 +528,16 @@ void Gx_matcheq_::connect_(uint32_t port,void* data)
   switch ((PortIndex)port)
     {
     case EFFECTS_OUTPUT:
-      output = static_cast<float*>(data);
+      output[0] = static_cast<float*>(data);
       break;
     case EFFECTS_INPUT:
-      input = static_cast<float*>(data);
+      input[0] = static_cast<float*>(data);
+      break;
+    case CONTROL:
+      control = static_cast<const LV2_Atom_Sequence*>(data);
+      break;
+    case NOTIFY:
+      notify = static_cast<LV2_Atom_Sequence*>(data);
       break;
     case BYPASS: 
       bypass = static_cast<float*>(data); // , 0.0, 0.0, 1.0, 1.0 
@@ -239,7 +548,19 @@ void Gx_matcheq_::connect_(uint32_t port,void* data)
     case CLEAR: 
       clear = static_cast<float*>(data); // , 0.0, 0.0, 1.0, 1.0 
       break;
+    case ENGINE: 
+      engine = static_cast<float*>(data); // , 1.0, 0.0, 1.0, 1.0 
+      break;
+    case LATENCY: 
+      latency = static_cast<float*>(data); // , 0.0, 0.0, 65536.0, 1.0 
+      break;
     default:
+      for (uint32_t c = 1; c < channels; c++) {
+        if (port == static_cast<uint32_t>(CHANNEL_OUTPUT(c)))
+          output[c] = static_cast<float*>(data);
+        else if (port == static_cast<uint32_t>(CHANNEL_INPUT(c)))
+          input[c] = static_cast<float*>(data);
+      }
       break;
     }
 }
@@ -249,6 +570,22 @@ void Gx_matcheq_::activate_f()
   // allocate the internal DSP mem
   if (matcheq->activate_plugin !=0)
     matcheq->activate_plugin(true, matcheq);
+  // the state is cleared with the values of the ports
+  for (int k = 0; k < CTLS; k++) {
+    if (ctl_port[k])
+      ctl_value[k] = ctl_host[k] = *(ctl_port[k]);
+  }
+  // latch the engine selection in the DSP class
+  if (engine)
+    engine_ = static_cast<uint32_t>(*(engine));
+  matcheq->clear_state(matcheq);
+  if (delay_buf)
+    memset(delay_buf, 0, delay_size * sizeof(float));
+  delay_pos = 0;
+  ramp_wait = static_cast<uint32_t>(matcheq->get_latency(matcheq));
+  // the buffers of the linear phase mode are written above, the rest of
+  // the instance gets its pages here
+  arena.prefault();
 }
 
 void Gx_matcheq_::clean_up()
@@ -267,12 +604,129 @@ void Gx_matcheq_::deactivate_f()
 
 void Gx_matcheq_::run_dsp_(uint32_t n_samples)
 {
+  mem_in_run = mem_check > 0;
   MXCSR.set_();
+  // the ports of the multichannel plugin above the first pair are optional
+  uint32_t n_ch = 1;
+  while (n_ch < channels && input[n_ch] && output[n_ch])
+    n_ch++;
+  // a control port the host moved wins over the events before
+  for (int k = 0; k < CTLS; k++) {
+    if (ctl_port[k] && *(ctl_port[k]) != ctl_host[k])
+      ctl_value[k] = ctl_host[k] = *(ctl_port[k]);
+  }
+  // the block runs in parts between the events which set a control
+  uint32_t pos = 0;
+  if (control) {
+    LV2_ATOM_SEQUENCE_FOREACH(control, ev) {
+      const LV2_Atom* value = NULL;
+      const int k = control_(&ev->body, &value);
+      if (k < 0)
+        continue;
+      const uint32_t t = static_cast<uint32_t>(
+        std::min<int64_t>(n_samples, std::max<int64_t>(pos, ev->time.frames)));
+      run_part_(pos, t - pos, n_ch);
+      pos = t;
+      set_control_(k, value);
+    }
+  }
+  run_part_(pos, n_samples - pos, n_ch);
+  notify_();
+  MXCSR.reset_();
+  mem_in_run = false;
+}
+
+// the spectrum of a match capture which ended in this block, if any
+void Gx_matcheq_::notify_()
+{
+  if (!notify || !urid_object)
+    return;
+  lv2_atom_forge_set_buffer(&forge, reinterpret_cast<uint8_t*>(notify),
+                            notify->atom.size);
+  LV2_Atom_Forge_Frame seq;
+  lv2_atom_forge_sequence_head(&forge, &seq, 0);
+  float level[CTL_MORPH];
+  const int m = matcheq->match_spectrum ? matcheq->match_spectrum(level, matcheq) : 0;
+  if (m) {
+    LV2_Atom_Forge_Frame obj;
+    lv2_atom_forge_frame_time(&forge, 0);
+    lv2_atom_forge_object(&forge, &obj, 0, urid_set);
+    lv2_atom_forge_key(&forge, urid_property);
+    lv2_atom_forge_urid(&forge, urid_match[m - 1]);
+    lv2_atom_forge_key(&forge, urid_value);
+    lv2_atom_forge_vector(&forge, sizeof(float), urid_float, CTL_MORPH, level);
+    lv2_atom_forge_pop(&forge, &obj);
+    // and the fractional octave bands when the analysis ran
+    float fine[SPECTRUM_MAX];
+    const int n = matcheq->match_detail ? matcheq->match_detail(fine, matcheq) : 0;
+    if (n) {
+      lv2_atom_forge_frame_time(&forge, 0);
+      lv2_atom_forge_object(&forge, &obj, 0, urid_set);
+      lv2_atom_forge_key(&forge, urid_property);
+      lv2_atom_forge_urid(&forge, urid_spectrum[m - 1]);
+      lv2_atom_forge_key(&forge, urid_value);
+      lv2_atom_forge_vector(&forge, sizeof(float), urid_float, n, fine);
+      lv2_atom_forge_pop(&forge, &obj);
+    }
+  }
+  lv2_atom_forge_pop(&forge, &seq);
+}
+
+void Gx_matcheq_::run_part_(uint32_t offset, uint32_t n_samples, uint32_t n_ch)
+{
+  // a host which doesn't bound the block length may exceed the dry buffer
+  for (uint32_t i = 0; i < n_samples; i += dry_size)
+    process_(offset + i, min(n_samples - i, dry_size), n_ch);
+}
+
+// the control a patch:Set sets, with its value, or -1
+int Gx_matcheq_::control_(const LV2_Atom* atom, const LV2_Atom** value)
+{
+  if (atom->type != urid_object || !urid_object)
+    return -1;
+  const LV2_Atom_Object* obj = reinterpret_cast<const LV2_Atom_Object*>(atom);
+  if (obj->body.otype != urid_set)
+    return -1;
+  const LV2_Atom* property = NULL;
+  lv2_atom_object_get(obj, urid_property, &property, urid_value, value, 0);
+  if (!property || !*value || property->type != urid_urid)
+    return -1;
+  const LV2_URID key = reinterpret_cast<const LV2_Atom_URID*>(property)->body;
+  for (int k = 0; k <= CTLS; k++) {
+    if (key == urid_param[k])
+      return (k == CTL_GAINS ? (*value)->type == urid_vector
+                             : (*value)->type == urid_float) ? k : -1;
+  }
+  return -1;
+}
+
+void Gx_matcheq_::set_control_(int k, const LV2_Atom* value)
+{
+  if (k < CTL_GAINS) {
+    ctl_value[k] = reinterpret_cast<const LV2_Atom_Float*>(value)->body;
+    return;
+  }
+  // GAINS: as many of G1 .. G11 as the vector has
+  const LV2_Atom_Vector* vec = reinterpret_cast<const LV2_Atom_Vector*>(value);
+  if (vec->atom.size < sizeof(LV2_Atom_Vector_Body) ||
+      vec->body.child_type != urid_float || vec->body.child_size != sizeof(float))
+    return;
+  const float* gain = static_cast<const float*>(LV2_ATOM_CONTENTS_CONST(LV2_Atom_Vector, vec));
+  const uint32_t n = (vec->atom.size - sizeof(LV2_Atom_Vector_Body)) / sizeof(float);
+  for (uint32_t b = 0; b < n && b < CTL_MORPH; b++)
+    ctl_value[b] = gain[b];
+}
 
-  FAUSTFLOAT buf[n_samples];
-  // do inplace processing at default
-  if (output != input)
-    memcpy(output, input, n_samples*sizeof(float));
+void Gx_matcheq_::process_(uint32_t offset, uint32_t n_samples, uint32_t n_ch)
+{
+  float* in[BANK_CHANNELS];
+  float* out[BANK_CHANNELS];
+  const float* dry[BANK_CHANNELS];
+  for (uint32_t c = 0; c < n_ch; c++) {
+    in[c] = input[c] + offset;
+    out[c] = output[c] + offset;
+    dry[c] = in[c];
+  }
   // check if bypass is pressed
   if (bypass_ != static_cast<uint32_t>(*(bypass))) {
     bypass_ = static_cast<uint32_t>(*(bypass));
@@ -303,31 +757,98 @@ void Gx_matcheq_::run_dsp_(uint32_t n_samples)
     }
   }
 
+  // engine switches take effect when the state is cleared at ramp down
+  if (engine_ != static_cast<uint32_t>(*(engine))) {
+    engine_ = static_cast<uint32_t>(*(engine));
+    if (bypassed) {
+      matcheq->clear_state(matcheq);
+      ramp_wait = static_cast<uint32_t>(matcheq->get_latency(matcheq));
+    } else {
+      needs_ramp_down = true;
+      needs_ramp_up = true;
+      engine_changed = true;
+    }
+  }
+
+  // the input goes through the delay line all the time, the dry side of
+  // the ramps and bypass take it with the latency of the engine
+  const uint32_t lat = static_cast<uint32_t>(matcheq->get_latency(matcheq));
+  if (delay_buf) {
+    const uint32_t mask = delay_size - 1;
+    for (uint32_t i = 0; i < n_samples; i++)
+      delay_buf[(delay_pos + i) & mask] = in[0][i];
+    if (lat && (bypassed || needs_ramp_down || needs_ramp_up)) {
+      for (uint32_t i = 0; i < n_samples; i++)
+        dry_buf[i] = delay_buf[(delay_pos - lat + i) & mask];
+      dry[0] = dry_buf;
+    }
+    delay_pos += n_samples;
+  }
+
+  // the ramps need the dry signal, which is gone when processing in place
   if (needs_ramp_down || needs_ramp_up) {
-       memcpy(buf, input, n_samples*sizeof(float));
+    for (uint32_t c = 0; c < n_ch; c++) {
+      if (dry[c] != in[c])
+        continue;
+      for (uint32_t d = 0; d < n_ch; d++) {
+        if (out[d] == in[c]) {
+          memcpy(dry_buf + c*dry_size, in[c], n_samples*sizeof(float));
+          dry[c] = dry_buf + c*dry_size;
+          break;
+        }
+      }
+    }
   }
-  
+
+  // samples of this block before the output of a cleared engine is valid
+  uint32_t wait = 0;
   if (!bypassed) {
-      matcheq->mono_audio(static_cast<int>(n_samples), output, output, matcheq);
+    wait = min(ramp_wait, n_samples);
+    ramp_wait -= wait;
+    // channels in lockstep, large mono buffers go through the time
+    // blocked variant when available
+    if (n_ch > 1)
+      matcheq->multi_audio(static_cast<int>(n_samples), static_cast<int>(n_ch), in, out, matcheq);
+    else if (n_samples >= BLOCK_MODE_MIN && matcheq->mono_audio_block)
+      matcheq->mono_audio_block(static_cast<int>(n_samples), in[0], out[0], matcheq);
+    else
+      matcheq->mono_audio(static_cast<int>(n_samples), in[0], out[0], matcheq);
+    // hand pending work of the DSP class to the worker thread, one job
+    // per request
+    if (schedule && matcheq->work_pending) {
+      uint32_t job;
+      while ((job = matcheq->work_pending(matcheq)))
+        schedule->schedule_work(schedule->handle, sizeof(job), &job);
+    }
+  } else {
+    for (uint32_t c = 0; c < n_ch; c++) {
+      if (out[c] != dry[c])
+        memcpy(out[c], dry[c], n_samples*sizeof(float));
+    }
+    // the same delay as the engine, the host's compensation stays put
+    if (latency)
+      *(latency) = static_cast<float>(lat);
   }
 
   // check if ramping is needed
   if (needs_ramp_down) {
-    float fade = 0;
-    for (uint32_t i=0; i<n_samples; i++) {
-      if (ramp_down >= 0.0) {
-        --ramp_down; 
-      }
-      fade = max(0.0,ramp_down) /ramp_down_step ;
-      output[i] = output[i] * fade + buf[i] * (1.0 - fade);
-    }
+    float pos = ramp_down;
+    for (uint32_t c = 0; c < n_ch; c++)
+      pos = crossfade_(out[c], dry[c], n_samples, ramp_down, -1.0f, ramp_down_step);
+    ramp_down = pos;
 
     if (ramp_down <= 0.0) {
       // when ramped down, clear buffer from matcheq class
       if (!no_clear) {
         matcheq->clear_state(matcheq);
         bypassed = true;
+      } else if (engine_changed) {
+        matcheq->clear_state(matcheq);
       }
+      // after a clear the engine takes its latency to fill
+      if (!no_clear || engine_changed)
+        ramp_wait = static_cast<uint32_t>(matcheq->get_latency(matcheq));
+      engine_changed = false;
       needs_ramp_down = false;
       ramp_down = ramp_down_step;
       ramp_up = 0.0;
@@ -336,14 +857,16 @@ void Gx_matcheq_::run_dsp_(uint32_t n_samples)
     }
 
   } else if (needs_ramp_up) {
-    float fade = 0;
-    for (uint32_t i=0; i<n_samples; i++) {
-      if (ramp_up < ramp_up_step) {
-        ++ramp_up ;
-      }
-      fade = min(ramp_up_step,ramp_up) /ramp_up_step ;
-      output[i] = output[i] * fade + buf[i] * (1.0 - fade);
+    // the dry side until then
+    for (uint32_t c = 0; c < n_ch && wait; c++) {
+      if (out[c] != dry[c])
+        memcpy(out[c], dry[c], wait*sizeof(float));
     }
+    float pos = ramp_up;
+    for (uint32_t c = 0; c < n_ch; c++)
+      pos = crossfade_(out[c] + wait, dry[c] + wait, n_samples - wait,
+                       ramp_up, 1.0f, ramp_up_step);
+    ramp_up = pos;
 
     if (ramp_up >= ramp_up_step) {
       needs_ramp_up = false;
@@ -353,12 +876,54 @@ void Gx_matcheq_::run_dsp_(uint32_t n_samples)
       ramp_down = ramp_up;
     }
   }
+}
 
-  MXCSR.reset_();
+// Mix out = dry + fade * (out - dry) with fade running linear from
+// (pos + dir) / step and clamped to 0 .. 1, so a ramp may end within the
+// block. Returns the position after the block.
+float Gx_matcheq_::crossfade_(float* out, const float* dry, uint32_t n_samples,
+                              float pos, float dir, float step)
+{
+  typedef BankVecF V;
+  typedef V::v vec;
+  const float scale = 1.0f / step;
+  const vec vpos = V::set1(pos * scale);
+  const vec vdir = V::set1(dir * scale);
+  const vec vzero = V::set1(0.0f);
+  const vec vone = V::set1(1.0f);
+  const vec vwidth = V::set1(static_cast<float>(V::W));
+  float first[V::W];
+  for (int w = 0; w < V::W; w++)
+    first[w] = static_cast<float>(w + 1);
+  vec vi = V::loadu(first);
+  uint32_t i = 0;
+  for (; i + V::W <= n_samples; i += V::W) {
+    const vec fade = V::vmin(vone, V::vmax(vzero, V::add(vpos, V::mul(vdir, vi))));
+    const vec d = V::loadu(dry + i);
+    V::storeu(out + i, V::add(d, V::mul(fade, V::sub(V::loadu(out + i), d))));
+    vi = V::add(vi, vwidth);
+  }
+  for (; i < n_samples; i++) {
+    const float fade = std::min<float>(1.0f, std::max<float>(0.0f, (pos + dir * (i + 1)) * scale));
+    out[i] = dry[i] + fade * (out[i] - dry[i]);
+  }
+  return std::min<float>(step, std::max<float>(0.0f, pos + dir * n_samples));
 }
 
 void Gx_matcheq_::connect_all__ports(uint32_t port, void* data)
 {
+  // the controls of the CONTROL port go through ctl_value
+  int k = -1;
+  if (port >= G1 && port <= G11)
+    k = port - G1;
+  else if (port == MORPH)
+    k = CTL_MORPH;
+  else if (port == BYPASS)
+    k = CTL_BYPASS;
+  if (k >= 0) {
+    ctl_port[k] = static_cast<float*>(data);
+    data = &ctl_value[k];
+  }
   // connect the Ports used by the plug-in class
   connect_(port,data); 
   // connect the Ports used by the DSP class
@@ -372,11 +937,72 @@ Gx_matcheq_::instantiate(const LV2_Descriptor* descriptor,
                             double rate, const char* bundle_path,
                             const LV2_Feature* const* features)
 {
-  // init the plug-in class
-  Gx_matcheq_ *self = new Gx_matcheq_();
-  if (!self) {
+  const char* check = getenv("MATCHEQ_ALLOC_CHECK");
+  if (check)
+    mem_check = strcmp(check, "abort") ? 1 : 2;
+
+  uint32_t channels = 1;
+  if (!strcmp(descriptor->URI, descriptor_stereo.URI))
+    channels = 2;
+  else if (!strcmp(descriptor->URI, descriptor_multi.URI))
+    channels = BANK_CHANNELS;
+
+  const LV2_Options_Option* options = NULL;
+  LV2_URID_Map* map = NULL;
+  LV2_Worker_Schedule* schedule = NULL;
+  for (int i = 0; features[i]; ++i) {
+    if (!strcmp(features[i]->URI, LV2_WORKER__schedule)) {
+      schedule = static_cast<LV2_Worker_Schedule*>(features[i]->data);
+    } else if (!strcmp(features[i]->URI, LV2_OPTIONS__options)) {
+      options = static_cast<const LV2_Options_Option*>(features[i]->data);
+    } else if (!strcmp(features[i]->URI, LV2_URID__map)) {
+      map = static_cast<LV2_URID_Map*>(features[i]->data);
+    }
+  }
+  // size the dry buffer for the largest block the host will run
+  uint32_t dry_size = DRY_BUF_DEFAULT;
+  if (options && map) {
+    const LV2_URID max_block = map->map(map->handle, LV2_BUF_SIZE__maxBlockLength);
+    const LV2_URID atom_int = map->map(map->handle, LV2_ATOM__Int);
+    for (const LV2_Options_Option* o = options; o->key; ++o) {
+      if (o->context == LV2_OPTIONS_INSTANCE && o->key == max_block &&
+          o->type == atom_int && *static_cast<const int32_t*>(o->value) > 0)
+        dry_size = static_cast<uint32_t>(*static_cast<const int32_t*>(o->value));
+    }
+  }
+
+  // init the plug-in class and the dsp class in the arena
+  const DspBuild build = select_dsp();
+  const size_t dry_bytes = channels * dry_size * sizeof(float);
+  uint32_t delay_size = 0;
+  if (channels == 1) {
+    delay_size = 1;
+    while (delay_size < build.max_latency(static_cast<uint32_t>(rate)) + dry_size)
+      delay_size *= 2;
+  }
+  const size_t delay_bytes = delay_size * sizeof(float);
+  Arena arena;
+  if (!arena.reserve(Arena::round(sizeof(Gx_matcheq_)) +
+                     Arena::round(build.size()) + Arena::round(dry_bytes) +
+                     Arena::round(delay_bytes)))
     return NULL;
+  void* mem = arena.take(sizeof(Gx_matcheq_));
+  PluginLV2* dsp = build.place(arena.take(build.size()));
+  Gx_matcheq_ *self = new (mem) Gx_matcheq_(dsp);
+  self->dry_buf = static_cast<float*>(arena.take(dry_bytes));
+  if (delay_size) {
+    self->delay_buf = static_cast<float*>(arena.take(delay_bytes));
+    self->delay_size = delay_size;
   }
+  self->arena = arena;
+  self->channels = channels;
+  self->dry_size = dry_size;
+  self->schedule = schedule;
+  if (map)
+    self->map_controls_(map);
+  // without the worker there is no linear phase mode
+  if (!self->schedule)
+    self->matcheq->work = 0;
 
   self->init_dsp_((uint32_t)rate);
 
@@ -413,7 +1039,42 @@ void Gx_matcheq_::cleanup(LV2_Handle instance)
   // well, clean up after us
   Gx_matcheq_* self = static_cast<Gx_matcheq_*>(instance);
   self->clean_up();
-  delete self;
+  Arena arena = self->arena;
+  self->~Gx_matcheq_();
+  arena.release();
+}
+
+LV2_Worker_Status Gx_matcheq_::work(LV2_Handle instance,
+                                    LV2_Worker_Respond_Function respond,
+                                    LV2_Worker_Respond_Handle handle,
+                                    uint32_t size, const void* data)
+{
+  // non realtime work of the DSP class
+  PluginLV2* dsp = static_cast<Gx_matcheq_*>(instance)->matcheq;
+  if (size != sizeof(uint32_t))
+    return LV2_WORKER_ERR_UNKNOWN;
+  if (dsp->work)
+    dsp->work(*static_cast<const uint32_t*>(data), dsp);
+  respond(handle, size, data);
+  return LV2_WORKER_SUCCESS;
+}
+
+LV2_Worker_Status Gx_matcheq_::work_response(LV2_Handle instance,
+                                             uint32_t size, const void* data)
+{
+  PluginLV2* dsp = static_cast<Gx_matcheq_*>(instance)->matcheq;
+  if (size == sizeof(uint32_t) && dsp->work_response)
+    dsp->work_response(*static_cast<const uint32_t*>(data), dsp);
+  return LV2_WORKER_SUCCESS;
+}
+
+const void* Gx_matcheq_::extension_data(const char* uri)
+{
+  static const LV2_Worker_Interface worker = { work, work_response, NULL };
+  if (!strcmp(uri, LV2_WORKER__interface)) {
+    return &worker;
+  }
+  return NULL;
 }
 
 const LV2_Descriptor Gx_matcheq_::descriptor =
@@ -425,7 +1086,31 @@ const LV2_Descriptor Gx_matcheq_::descriptor =
   Gx_matcheq_::run,
   Gx_matcheq_::deactivate,
   Gx_matcheq_::cleanup,
-  NULL
+  Gx_matcheq_::extension_data
+};
+
+const LV2_Descriptor Gx_matcheq_::descriptor_stereo =
+{
+  GXPLUGIN_URI "#_matcheq_stereo",
+  Gx_matcheq_::instantiate,
+  Gx_matcheq_::connect_port,
+  Gx_matcheq_::activate,
+  Gx_matcheq_::run,
+  Gx_matcheq_::deactivate,
+  Gx_matcheq_::cleanup,
+  Gx_matcheq_::extension_data
+};
+
+const LV2_Descriptor Gx_matcheq_::descriptor_multi =
+{
+  GXPLUGIN_URI "#_matcheq_multi",
+  Gx_matcheq_::instantiate,
+  Gx_matcheq_::connect_port,
+  Gx_matcheq_::activate,
+  Gx_matcheq_::run,
+  Gx_matcheq_::deactivate,
+  Gx_matcheq_::cleanup,
+  Gx_matcheq_::extension_data
 };
 
 
@@ -442,9 +1127,39 @@ lv2_descriptor(uint32_t index)
     {
     case 0:
       return &matcheq::Gx_matcheq_::descriptor;
+    case 1:
+      return &matcheq::Gx_matcheq_::descriptor_stereo;
+    case 2:
+      return &matcheq::Gx_matcheq_::descriptor_multi;
     default:
       return NULL;
     }
 }
 
+////////////////////////// BATCH API ///////////////////////////////////
+
+// see gx_matcheq_batch.h, all instances and their batches come from the
+// build picked on the first call
+static const matcheq::DspBuild& batch_build()
+{
+  static const matcheq::DspBuild build = matcheq::select_dsp();
+  return build;
+}
+
+extern "C"
+LV2_SYMBOL_EXPORT
+PluginLV2*
+matcheq_plugin()
+{
+  return batch_build().plugin();
+}
+
+extern "C"
+LV2_SYMBOL_EXPORT
+BatchLV2*
+matcheq_batch(PluginLV2** instances, int count)
+{
+  return batch_build().batch(instances, count);
+}
+
 ///////////////////////////// FIN //////////////////////////////////////
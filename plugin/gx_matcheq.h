@@ -61,6 +61,42 @@ typedef enum
    CLEAR, 
    PROFILE,
    MORPH,
+   ENGINE,
+   LATENCY,
+   SKIPPED,
+   FLAT,
+   CONTROL,      // atom input, patch:Set of the parameters below
+   METER_MODE,   // band meters: 0 off, 1 peak, 2 rms
+   METER_MS,     // integration time of the band meters
+   NOTIFY,       // atom output, patch:Set of the match spectra below
+   RESOLUTION,   // bands per octave of the spectra, 6 or 12
+   PORTS_SHARED, // first port of the stereo and multichannel variants
 } PortIndex;
 
+// Parameters of the CONTROL port, which a patch:Set sets at the frame of
+// its event: GXPLUGIN_PARAM "G1" .. "G11", "MORPH" and "BYPASS" take an
+// atom:Float like their control port, "GAINS" an atom:Vector of floats
+// with G1 .. G11 in one event.
+#define GXPLUGIN_PARAM GXPLUGIN_URI "#"
+
+// Parameters of the NOTIFY port: when a match capture ends, a patch:Set
+// of GXPLUGIN_PARAM "MATCH1" or "MATCH2" carries an atom:Vector of floats
+// with the mean level in dB of the bands of G1 .. G11 over the capture.
+// When the host has a worker thread these come from a spectrum analysis
+// of the capture, and GXPLUGIN_PARAM "SPECTRUM1" or
+// "SPECTRUM2" follows in the same block with the mean level in dB of the
+// 1/R octave bands centred on SPECTRUM_LOW * 2^(j / R), for
+// j = 0 .. SPECTRUM_OCTAVES * R, R the RESOLUTION the capture started
+// with. The bands above half the sample rate are at the floor.
+#define SPECTRUM_LOW 20.0
+#define SPECTRUM_OCTAVES 10
+#define SPECTRUM_MAX (SPECTRUM_OCTAVES * 12 + 1)
+
+// ports of the stereo and multichannel variants, for channel c = 1 .. 7,
+// channel 0 is EFFECTS_OUTPUT/EFFECTS_INPUT
+#define ANALYSIS PORTS_SHARED
+#define CHANNEL_OUTPUT(c) (PORTS_SHARED + 2 * (c) - 1)
+#define CHANNEL_INPUT(c) (PORTS_SHARED + 2 * (c))
+#define BANK_CHANNELS 8  // most channels of the multichannel plugin
+
 #endif //SRC_HEADERS_GXEFFECTS_H_
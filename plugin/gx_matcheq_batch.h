@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2014 Guitarix project MOD project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * --------------------------------------------------------------------------
+ */
+
+// Many instances of the EQ in one call, for hosts which run it on every
+// channel strip of a console. Exported by gx_matcheq.so next to
+// lv2_descriptor(), or linked in with the objects of the plugin.
+//
+//   PluginLV2 *p[K];
+//   for (int k = 0; k < K; k++) {
+//     p[k] = matcheq_plugin();
+//     p[k]->set_samplerate(rate, p[k]);
+//     for each port in PortIndex: p[k]->connect_ports(port, &value, p[k]);
+//     p[k]->clear_state(p[k]);   // takes the engine from its port
+//   }
+//   BatchLV2 *b = matcheq_batch(p, K);
+//   ...
+//   b->batch_audio(n, inputs, outputs, b);  // audio thread, per block
+//   ...
+//   b->delete_batch(b);
+//   for (int k = 0; k < K; k++) p[k]->delete_instance(p[k]);
+//
+// The control ports are read in batch_audio() like in run() of the plugin,
+// the meter and latency ports written. Instances at the same sample rate
+// share one set of tree coefficients and run four to a vector, each with
+// its own parameters. The filter state lives in the batch, so an instance
+// must not be run on its own while it is in one. Like the multichannel
+// plugins, all engines run the tree without latency.
+//
+// C++ only, PluginLV2 is a C++ struct; the functions have C linkage for
+// dlsym(). The port numbers are PortIndex of gx_matcheq.h. A caller built
+// against another layout of PluginLV2 sees it in the major version:
+//   (p->version & PLUGINLV2_VERMAJOR_MASK) == (PLUGINLV2_VERSION & PLUGINLV2_VERMAJOR_MASK)
+
+#pragma once
+
+#ifndef SRC_HEADERS_GX_MATCHEQ_BATCH_H_
+#define SRC_HEADERS_GX_MATCHEQ_BATCH_H_
+
+#ifndef __cplusplus
+#error "gx_matcheq_batch.h is C++ only"
+#endif
+
+#include <stdint.h>
+
+#include "gx_pluginlv2.h"   // define struct PluginLV2 and BatchLV2
+
+extern "C" {
+
+// a new instance of the dsp, of the build for the CPU we run on
+PluginLV2 *matcheq_plugin();
+
+// a batch of count instances of matcheq_plugin(), after set_samplerate()
+// and connect_ports(); 0 when there is nothing to run. Not from the
+// audio thread, it allocates.
+BatchLV2 *matcheq_batch(PluginLV2 **instances, int count);
+
+}
+
+#endif //SRC_HEADERS_GX_MATCHEQ_BATCH_H_
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2014 Guitarix project MOD project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * --------------------------------------------------------------------------
+ */
+
+
+// The dsp of the plugin. The Makefile compiles this file once per
+// instruction set, with MATCHEQ_VARIANT naming the namespace of the build
+// (matcheq_sse2, matcheq_avx2, ...) which then stands in for namespace
+// matcheq in all of the dsp sources. The wrapper only reaches a build
+// through its plugin(), see select_dsp() in gx_matcheq.cpp.
+
+#include <atomic>
+#include <cstdlib>
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <stdint.h>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+#ifdef NOSSE
+#undef __SSE__
+#endif
+
+////////////////////////////// LOCAL INCLUDES //////////////////////////
+
+#include "gx_matcheq.h"        // define struct PortIndex
+#include "gx_pluginlv2.h"   // define struct PluginLV2
+#include "gx_matcheq_dsp.h"    // macro and faust support
+
+#ifndef MATCHEQ_VARIANT
+#define MATCHEQ_VARIANT matcheq_generic
+#endif
+#define matcheq MATCHEQ_VARIANT
+
+#include "matcheq_vec.h"      // vector types of this build
+#include "matcheq_simd.cc"    // hand written SIMD filterbank kernel
+#include "matcheq_design.cc"  // shared parts of the worker designed engines
+#include "matcheq_fir.cc"     // linear phase mode
+#include "matcheq_fit.cc"     // fitted biquad mode
+#include "matcheq_spec.cc"    // spectrum analysis of the match captures
+#include "matcheq.cc"    // dsp class generated by faust -> dsp2cc
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2014 Guitarix project MOD project
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * --------------------------------------------------------------------------
+ */
+
+
+// Shared by the plugin wrapper gx_matcheq.cpp and the builds of the dsp in
+// gx_matcheq_dsp.cpp, one build per instruction set.
+
+#pragma once
+
+#ifndef SRC_HEADERS_GX_MATCHEQ_DSP_H_
+#define SRC_HEADERS_GX_MATCHEQ_DSP_H_
+
+///////////////////////// MACRO SUPPORT ////////////////////////////////
+
+#define __rt_func __attribute__((section(".rt.text")))
+#define __rt_data __attribute__((section(".rt.data")))
+
+///////////////////////// FAUST SUPPORT ////////////////////////////////
+
+#define FAUSTFLOAT float
+#ifndef N_
+#define N_(String) (String)
+#endif
+#define max(x, y) (((x) > (y)) ? (x) : (y))
+#define min(x, y) (((x) < (y)) ? (x) : (y))
+
+#define always_inline inline __attribute__((always_inline))
+
+#ifndef signbit
+#define signbit(x) std::signbit(x)
+#endif
+
+template<class T> constexpr T mydsp_faustpower2_f(T x) {return (x * x);}
+template<class T> constexpr T mydsp_faustpower3_f(T x) {return ((x * x) * x);}
+template<class T> constexpr T mydsp_faustpower4_f(T x) {return (((x * x) * x) * x);}
+template<class T> constexpr T mydsp_faustpower5_f(T x) {return ((((x * x) * x) * x) * x);}
+template<class T> constexpr T mydsp_faustpower6_f(T x) {return (((((x * x) * x) * x) * x) * x);}
+
+///////////////////////// MEMORY ///////////////////////////////////////
+
+// alignment of the instance memory and of the buffers of the dsp
+#define MEM_ALIGN 64
+
+// Heap memory of the dsp, aligned to MEM_ALIGN, defined in gx_matcheq.cpp.
+// Not for the audio thread: with MATCHEQ_ALLOC_CHECK set in the environment
+// every call made inside run() is reported on stderr, with
+// MATCHEQ_ALLOC_CHECK=abort it aborts.
+void *mem_get(size_t bytes);
+void mem_put(void *p);
+
+// n value initialized T from mem_get(), given back with mem_put()
+template<class T> T *mem_new(size_t n)
+{
+  static_assert(std::is_trivially_destructible<T>::value, "mem_put() runs no destructors");
+  T *p = static_cast<T*>(mem_get(n * sizeof(T)));
+  if (!p) throw std::bad_alloc();
+  for (size_t i = 0; i < n; i++) new (p + i) T();
+  return p;
+}
+
+///////////////////////// DSP BUILDS ///////////////////////////////////
+
+// the builds of the dsp, in the order of preference when the CPU has
+// them; each one lives in its own namespace, see gx_matcheq_dsp.cpp
+enum {
+   DSP_GENERIC,  // no SIMD, any CPU
+   DSP_SSE2,
+   DSP_AVX2,     // AVX2 + FMA
+   DSP_AVX512,   // AVX-512 F/VL/DQ, 256 bit vectors with 32 registers
+   DSP_NEON,     // ARM, double precision vectors on AArch64 only
+   DSP_BUILDS,
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DSP_X86
+#elif defined(__aarch64__) || defined(__arm__)
+#define DSP_ARM
+#endif
+
+// plugin() news the dsp class, place() constructs it in size() bytes at
+// MEM_ALIGN owned by the caller; delete_instance() handles both.
+// max_latency() is the most delay any engine has at the rate.
+// batch() runs instances of plugin() of the same build together, see
+// gx_matcheq_batch.h.
+#define DSP_ENTRY PluginLV2 *plugin(); size_t size(); PluginLV2 *place(void *mem); \
+  int max_latency(uint32_t rate); BatchLV2 *batch(PluginLV2 **instances, int count);
+
+namespace matcheq_generic { DSP_ENTRY }
+#ifdef DSP_X86
+namespace matcheq_sse2 { DSP_ENTRY }
+namespace matcheq_avx2 { DSP_ENTRY }
+namespace matcheq_avx512 { DSP_ENTRY }
+#endif
+#ifdef DSP_ARM
+namespace matcheq_neon { DSP_ENTRY }
+#endif
+
+#endif //SRC_HEADERS_GX_MATCHEQ_DSP_H_